@@ -0,0 +1,126 @@
+#include "AnalysisCache.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+
+ProgressionAnalysisCache::ProgressionAnalysisCache(std::size_t keyWindow, int voicingOctave)
+    : m_keyWindow(keyWindow),
+      m_voicingOctave(voicingOctave),
+      m_valid(false),
+      m_revision(0)
+{
+    // validates the window the same way the analyzer does
+    KeyAnalyzer check(keyWindow);
+    (void)check;
+}
+
+const std::vector<ChordAnalysis>& ProgressionAnalysisCache::entries() const {
+    return m_entries;
+}
+
+const ProgressionAnalysisCache::Counters& ProgressionAnalysisCache::counters() const {
+    return m_counters;
+}
+
+void ProgressionAnalysisCache::resetCounters() {
+    m_counters = Counters();
+}
+
+/**
+ * A key label depends on the chords in its window, so a change at 'from'
+ * touches the labels [from, from + count + window - 1).
+ */
+void ProgressionAnalysisCache::markKeys(std::size_t from, std::size_t count) {
+    std::size_t end = std::min(m_keyDirty.size(), from + count + m_keyWindow - 1);
+    for (std::size_t i = from; i < end; ++i) {
+        m_keyDirty[i] = 1;
+    }
+}
+
+void ProgressionAnalysisCache::analyzeChord(const Chord& chord, ChordAnalysis& out) const {
+    out.components = chord.components();
+    int bass = noteToVal(chord.rootView());
+    if (!chord.onView().empty()) {
+        bass = noteToVal(chord.onView());
+    }
+    out.canonicalKey = (static_cast<std::uint32_t>(bass) << 12) | chord.pitchClassMask();
+    out.voicing.resize(chord.componentCount());
+    chord.pitches(m_voicingOctave, out.voicing.begin());
+}
+
+const std::vector<ChordAnalysis>& ProgressionAnalysisCache::update(const ChordProgression& progression) {
+    ++m_counters.updates;
+    const auto& chords = progression.chords();
+
+    // 1) Replay the edit log onto our entries and dirty flags
+    std::vector<ProgressionEdit> edits;
+    bool incremental = m_valid && progression.editsSince(m_revision, edits);
+    for (const auto& e : edits) {
+        if (!incremental) break;
+        switch (e.kind) {
+        case ProgressionEdit::Insert:
+            m_entries.insert(m_entries.begin() + e.index, e.count, ChordAnalysis());
+            m_chordDirty.insert(m_chordDirty.begin() + e.index, e.count, 1);
+            m_keyDirty.insert(m_keyDirty.begin() + e.index, e.count, 1);
+            markKeys(e.index, e.count);
+            break;
+        case ProgressionEdit::Erase:
+            m_entries.erase(m_entries.begin() + e.index, m_entries.begin() + e.index + e.count);
+            m_chordDirty.erase(m_chordDirty.begin() + e.index, m_chordDirty.begin() + e.index + e.count);
+            m_keyDirty.erase(m_keyDirty.begin() + e.index, m_keyDirty.begin() + e.index + e.count);
+            markKeys(e.index, 0);
+            break;
+        case ProgressionEdit::Replace:
+            std::fill(m_chordDirty.begin() + e.index, m_chordDirty.begin() + e.index + e.count, 1);
+            markKeys(e.index, e.count);
+            break;
+        case ProgressionEdit::Reset:
+            incremental = false;
+            break;
+        }
+    }
+    // Anything the log does not describe (e.g. edits through the non-const chords()) means start over
+    if (!incremental || m_entries.size() != chords.size()) {
+        ++m_counters.fullRebuilds;
+        m_entries.assign(chords.size(), ChordAnalysis());
+        m_chordDirty.assign(chords.size(), 1);
+        m_keyDirty.assign(chords.size(), 1);
+    }
+
+    // 2) Per-chord data
+    for (std::size_t i = 0; i < chords.size(); ++i) {
+        if (m_chordDirty[i]) {
+            analyzeChord(chords[i], m_entries[i]);
+            m_chordDirty[i] = 0;
+            ++m_counters.chordsRecomputed;
+        } else {
+            ++m_counters.chordsReused;
+        }
+    }
+
+    // 3) Key labels: replay each dirty run, seeded with the window before it
+    std::size_t i = 0;
+    while (i < chords.size()) {
+        if (!m_keyDirty[i]) {
+            ++m_counters.keyLabelsReused;
+            ++i;
+            continue;
+        }
+        KeyAnalyzer analyzer(m_keyWindow);
+        std::size_t seed = (i >= m_keyWindow - 1) ? i - (m_keyWindow - 1) : 0;
+        for (std::size_t k = seed; k < i; ++k) {
+            analyzer.push(chords[k]);
+            ++m_counters.keySeedPushes;
+        }
+        while (i < chords.size() && m_keyDirty[i]) {
+            m_entries[i].key = analyzer.push(chords[i]);
+            m_keyDirty[i] = 0;
+            ++m_counters.keyLabelsRecomputed;
+            ++i;
+        }
+    }
+
+    m_valid = true;
+    progression.subscribeEdits();
+    m_revision = progression.revision();
+    return m_entries;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "ChordProgression.hpp"
+#include "KeyAnalyzer.hpp"
+
+/**
+ * Derived data for one chord of a progression.
+ */
+struct ChordAnalysis {
+    std::vector<int> components;  // Chord::components()
+    std::uint32_t canonicalKey;   // (bass pitch class << 12) | pitch-class mask
+    std::vector<int> voicing;     // MIDI notes from Chord::pitches at the cache's octave
+    KeyLabel key;                 // sliding-window key and Roman numeral
+};
+
+/**
+ * Incremental analysis of an edited progression. update() replays the
+ * progression's edit log since the last call and recomputes only the chords
+ * that changed, plus the key labels whose window covers a change.
+ */
+class ProgressionAnalysisCache {
+public:
+    struct Counters {
+        std::uint64_t updates = 0;
+        std::uint64_t fullRebuilds = 0;      // log unavailable, everything recomputed
+        std::uint64_t chordsRecomputed = 0;  // components / canonical key / voicing
+        std::uint64_t chordsReused = 0;
+        std::uint64_t keyLabelsRecomputed = 0;
+        std::uint64_t keyLabelsReused = 0;
+        std::uint64_t keySeedPushes = 0;     // chords replayed to refill a key window
+    };
+
+    explicit ProgressionAnalysisCache(std::size_t keyWindow = 8, int voicingOctave = 4);
+
+    // Bring the cache in line with 'progression' and return one entry per chord
+    const std::vector<ChordAnalysis>& update(const ChordProgression& progression);
+
+    const std::vector<ChordAnalysis>& entries() const;
+    const Counters& counters() const;
+    void resetCounters();
+
+private:
+    std::size_t m_keyWindow;
+    int m_voicingOctave;
+    bool m_valid;
+    std::uint64_t m_revision;
+    std::vector<ChordAnalysis> m_entries;
+    std::vector<char> m_chordDirty;
+    std::vector<char> m_keyDirty;
+    Counters m_counters;
+
+    void markKeys(std::size_t from, std::size_t count);
+    void analyzeChord(const Chord& chord, ChordAnalysis& out) const;
+};
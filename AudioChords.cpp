@@ -0,0 +1,326 @@
+#include "AudioChords.hpp"
+#include "Parallel.hpp"
+#include "QualityManager.hpp"
+#include "Utils.hpp"
+#include "WavReader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+static const double PI = 3.14159265358979323846;
+
+ChromaChordRecognizer::ChromaChordRecognizer(double sampleRate, const ChromaOptions& options)
+    : m_sampleRate(sampleRate), m_options(options)
+{
+    const std::size_t n = options.frameSize;
+    if (sampleRate <= 0) {
+        throw std::runtime_error("Sample rate must be positive.");
+    }
+    if (n < 16 || (n & (n - 1)) != 0) {
+        throw std::runtime_error("ChromaOptions::frameSize must be a power of two of at least 16.");
+    }
+    if (options.hopSize == 0 || options.hopSize > n) {
+        throw std::runtime_error("ChromaOptions::hopSize must be in [1, frameSize].");
+    }
+    if (options.selfTransition <= 0.0f || options.selfTransition >= 1.0f) {
+        throw std::runtime_error("ChromaOptions::selfTransition must be in (0, 1).");
+    }
+
+    // Hann window, twiddles and bit-reversal permutation for the radix-2 FFT
+    m_window.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / n));
+    }
+    m_twiddles.resize(n / 2);
+    for (std::size_t k = 0; k < n / 2; ++k) {
+        m_twiddles[k] = std::polar(1.0f, static_cast<float>(-2.0 * PI * k / n));
+    }
+    int bits = 0;
+    while ((std::size_t(1) << bits) < n) ++bits;
+    m_bitReverse.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+    m_spectrum.resize(n);
+
+    // Fold FFT bins onto pitch classes (A4 = 440 Hz, pitch class 9)
+    m_binClass.assign(n / 2 + 1, -1);
+    for (std::size_t k = 1; k <= n / 2; ++k) {
+        double freq = k * sampleRate / n;
+        if (freq < options.minFrequency || freq > options.maxFrequency) continue;
+        long midi = std::lround(69.0 + 12.0 * std::log2(freq / 440.0));
+        m_binClass[k] = static_cast<int>(((midi % 12) + 12) % 12);
+    }
+
+    // Templates: "N" is flat, chords weight their tones and overtones
+    auto& manager = QualityManager::Instance();
+    m_size = 1 + 12 * options.qualities.size();
+    if (m_size > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::runtime_error("ChromaOptions::qualities is too large.");
+    }
+    m_templates.assign(m_size * 12, 0.0f);
+    std::fill(m_templates.begin(), m_templates.begin() + 12, 1.0f / std::sqrt(12.0f));
+    for (std::size_t q = 0; q < options.qualities.size(); ++q) {
+        if (!manager.hasQuality(options.qualities[q])) {
+            throw std::runtime_error("Unknown quality in ChromaOptions: " + options.qualities[q]);
+        }
+        auto quality = manager.getQuality(options.qualities[q]);
+        unsigned mask = 0;
+        for (int interval : quality->getIntervals()) {
+            mask |= 1u << (((interval % 12) + 12) % 12);
+        }
+        for (int root = 0; root < 12; ++root) {
+            float* t = &m_templates[(1 + root * options.qualities.size() + q) * 12];
+            for (int pc = 0; pc < 12; ++pc) {
+                if (!(mask & (1u << pc))) continue;
+                // Each tone brings its first harmonics (octaves, fifth, third) with decaying weight
+                const int tone = root + pc;
+                t[tone % 12] += 1.0f + 0.6f + 0.216f;
+                t[(tone + 7) % 12] += 0.36f;
+                t[(tone + 4) % 12] += 0.1296f;
+            }
+            float norm = 0.0f;
+            for (int pc = 0; pc < 12; ++pc) norm += t[pc] * t[pc];
+            norm = 1.0f / std::sqrt(norm);
+            for (int pc = 0; pc < 12; ++pc) t[pc] *= norm;
+        }
+    }
+    m_emission.resize(m_size);
+    m_delta.resize(m_size);
+    m_nextDelta.resize(m_size);
+}
+
+void ChromaChordRecognizer::push(const float* samples, std::size_t count) {
+    if (m_finished) {
+        throw std::runtime_error("ChromaChordRecognizer::push called after finish.");
+    }
+    m_samplesSeen += count;
+    m_samples.insert(m_samples.end(), samples, samples + count);
+    std::size_t offset = 0;
+    while (m_samples.size() - offset >= m_options.frameSize) {
+        for (std::size_t i = 0; i < m_options.frameSize; ++i) {
+            m_spectrum[m_bitReverse[i]] = m_samples[offset + i] * m_window[i];
+        }
+        analyzeFrame();
+        offset += m_options.hopSize;
+    }
+    m_samples.erase(m_samples.begin(), m_samples.begin() + offset);
+}
+
+void ChromaChordRecognizer::fft() {
+    const std::size_t n = m_options.frameSize;
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        const std::size_t step = n / len;
+        for (std::size_t i = 0; i < n; i += len) {
+            for (std::size_t j = 0; j < len / 2; ++j) {
+                std::complex<float> u = m_spectrum[i + j];
+                std::complex<float> v = m_spectrum[i + j + len / 2] * m_twiddles[j * step];
+                m_spectrum[i + j] = u + v;
+                m_spectrum[i + j + len / 2] = u - v;
+            }
+        }
+    }
+}
+
+void ChromaChordRecognizer::analyzeFrame() {
+    fft();
+
+    const std::size_t n = m_options.frameSize;
+    float power = 0.0f;
+    std::fill(m_chroma, m_chroma + 12, 0.0f);
+    for (std::size_t k = 1; k <= n / 2; ++k) {
+        float magnitude = std::abs(m_spectrum[k]);
+        power += magnitude * magnitude;
+        if (m_binClass[k] >= 0) m_chroma[m_binClass[k]] += magnitude * magnitude;
+    }
+    power /= static_cast<float>(n) * n;
+
+    float norm = 0.0f;
+    for (float c : m_chroma) {
+        norm += c * c;
+    }
+    const bool silent = power < m_options.silenceThreshold || norm == 0.0f;
+    if (silent) {
+        std::fill(m_chroma, m_chroma + 12, 0.0f);
+    } else {
+        norm = 1.0f / std::sqrt(norm);
+        for (float& c : m_chroma) c *= norm;
+    }
+
+    // Cosine similarity against every template (plain loops, vectorized by the compiler)
+    for (std::size_t s = 0; s < m_size; ++s) {
+        const float* t = &m_templates[s * 12];
+        float dot = 0.0f;
+        for (int pc = 0; pc < 12; ++pc) dot += m_chroma[pc] * t[pc];
+        m_emission[s] = m_options.emissionScale * dot;
+    }
+    if (silent) {
+        m_emission[0] = m_options.emissionScale;
+    }
+
+    // Viterbi step; with uniform switching the best predecessor is either the
+    // same state or the overall best, so a step is O(states)
+    const float logStay = std::log(m_options.selfTransition);
+    const float logSwitch = std::log((1.0f - m_options.selfTransition) / (m_size - 1));
+    if (m_frameIndex == m_decided) {
+        m_delta = m_emission;
+    } else {
+        std::size_t best = static_cast<std::size_t>(std::max_element(m_delta.begin(), m_delta.end()) - m_delta.begin());
+        std::vector<std::uint16_t> back(m_size);
+        for (std::size_t s = 0; s < m_size; ++s) {
+            float stay = m_delta[s] + logStay;
+            float move = m_delta[best] + logSwitch;
+            if (stay >= move) {
+                m_nextDelta[s] = stay + m_emission[s];
+                back[s] = static_cast<std::uint16_t>(s);
+            } else {
+                m_nextDelta[s] = move + m_emission[s];
+                back[s] = static_cast<std::uint16_t>(best);
+            }
+        }
+        // Keep scores small; only differences matter
+        const float top = *std::max_element(m_nextDelta.begin(), m_nextDelta.end());
+        for (std::size_t s = 0; s < m_size; ++s) m_delta[s] = m_nextDelta[s] - top;
+        m_backPointers.push_back(std::move(back));
+    }
+    ++m_frameIndex;
+
+    if (m_frameIndex - m_decided > std::max<std::size_t>(1, m_options.smoothingLag)) {
+        std::size_t best = static_cast<std::size_t>(std::max_element(m_delta.begin(), m_delta.end()) - m_delta.begin());
+        emitOldest(best);
+    }
+}
+
+// Decide the oldest pending frame by backtracking from the current best state
+void ChromaChordRecognizer::emitOldest(std::size_t bestState) {
+    std::size_t state = bestState;
+    for (auto it = m_backPointers.rbegin(); it != m_backPointers.rend(); ++it) {
+        state = (*it)[state];
+    }
+    emitState(state);
+    if (!m_backPointers.empty()) {
+        m_backPointers.pop_front();
+    }
+}
+
+void ChromaChordRecognizer::emitState(std::size_t state) {
+    if (!m_haveCurrent) {
+        m_currentState = state;
+        m_currentStart = m_decided;
+        m_haveCurrent = true;
+    } else if (state != m_currentState) {
+        closeSegment(frameTime(m_decided));
+        m_currentState = state;
+        m_currentStart = m_decided;
+    }
+    ++m_decided;
+}
+
+void ChromaChordRecognizer::closeSegment(double endTime) {
+    if (m_currentState == 0) {
+        return;  // no chord
+    }
+    const std::size_t qualities = m_options.qualities.size();
+    const int root = static_cast<int>((m_currentState - 1) / qualities);
+    const std::string& quality = m_options.qualities[(m_currentState - 1) % qualities];
+    m_result.progression.append(Chord::fromParts(valToNote(root), quality));
+    m_result.startTimes.push_back(frameTime(m_currentStart));
+    m_result.endTimes.push_back(endTime);
+}
+
+// Boundary before 'frame': halfway between the centres of it and the previous frame
+double ChromaChordRecognizer::frameTime(std::size_t frame) const {
+    if (frame == 0) {
+        return 0.0;
+    }
+    const double offset = (static_cast<double>(m_options.frameSize) - m_options.hopSize) / 2.0;
+    return (static_cast<double>(frame) * m_options.hopSize + offset) / m_sampleRate;
+}
+
+void ChromaChordRecognizer::finish() {
+    if (m_finished) {
+        return;
+    }
+    // Audio shorter than one frame still gets one (zero-padded) frame
+    if (m_frameIndex == 0 && !m_samples.empty()) {
+        for (std::size_t i = 0; i < m_options.frameSize; ++i) {
+            float x = i < m_samples.size() ? m_samples[i] : 0.0f;
+            m_spectrum[m_bitReverse[i]] = x * m_window[i];
+        }
+        analyzeFrame();
+    }
+    m_samples.clear();
+
+    // Final decode of the pending window along one consistent path
+    if (m_frameIndex > m_decided) {
+        std::vector<std::size_t> path(m_frameIndex - m_decided);
+        std::size_t state = static_cast<std::size_t>(std::max_element(m_delta.begin(), m_delta.end()) - m_delta.begin());
+        path.back() = state;
+        for (std::size_t i = path.size() - 1; i > 0; --i) {
+            state = m_backPointers[i - 1][state];
+            path[i - 1] = state;
+        }
+        for (std::size_t s : path) emitState(s);
+        m_backPointers.clear();
+    }
+    if (m_haveCurrent) {
+        closeSegment(std::max(frameTime(m_currentStart), m_samplesSeen / m_sampleRate));
+        m_haveCurrent = false;
+    }
+    m_finished = true;
+}
+
+const AudioChordResult& ChromaChordRecognizer::result() const {
+    return m_result;
+}
+
+AudioChordResult ChromaChordRecognizer::takeResult() {
+    AudioChordResult out = std::move(m_result);
+    m_result = AudioChordResult();
+    return out;
+}
+
+std::size_t ChromaChordRecognizer::vocabularySize() const {
+    return m_size;
+}
+
+std::string ChromaChordRecognizer::vocabularySymbol(std::size_t index) const {
+    if (index >= m_size) {
+        throw std::runtime_error("Index out of range in ChromaChordRecognizer::vocabularySymbol.");
+    }
+    if (index == 0) {
+        return "N";
+    }
+    const std::size_t qualities = m_options.qualities.size();
+    return valToNote(static_cast<int>((index - 1) / qualities)) + m_options.qualities[(index - 1) % qualities];
+}
+
+const float* ChromaChordRecognizer::lastChroma() const {
+    return m_chroma;
+}
+
+AudioChordResult recognizeChordsFromWav(const std::string& path, const ChromaOptions& options) {
+    WavReader reader(path);
+    ChromaChordRecognizer recognizer(reader.sampleRate(), options);
+    std::vector<float> block(16384);
+    while (std::size_t frames = reader.readMono(block.data(), block.size())) {
+        recognizer.push(block.data(), frames);
+    }
+    recognizer.finish();
+    return recognizer.takeResult();
+}
+
+std::vector<AudioChordResult> recognizeChordsBatch(const std::vector<std::string>& paths,
+                                                   const ChromaOptions& options,
+                                                   unsigned threads) {
+    std::vector<AudioChordResult> results(paths.size());
+    parallelFor(paths.size(), threads, [&](std::size_t i) {
+        results[i] = recognizeChordsFromWav(paths[i], options);
+    });
+    return results;
+}
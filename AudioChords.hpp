@@ -0,0 +1,103 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * Chord recognition from audio: STFT chromagram (built-in radix-2 FFT, bins
+ * folded onto the 12 pitch classes), cosine matching against templates built
+ * from QualityManager, and fixed-lag Viterbi smoothing. Audio is pushed in
+ * blocks of any size; memory stays bounded by frameSize and smoothingLag.
+ */
+
+struct ChromaOptions {
+    std::size_t frameSize = 4096;     // samples per FFT frame, power of two
+    std::size_t hopSize = 2048;       // samples between frames
+    double minFrequency = 55.0;       // Hz folded into the chroma
+    double maxFrequency = 2000.0;
+    // Qualities making up the vocabulary, on every one of the 12 roots; "N" (no chord) is always added
+    std::vector<std::string> qualities = {"", "m", "7", "maj7", "m7", "dim", "aug", "sus4"};
+    float emissionScale = 20.0f;      // log emission = emissionScale * cosine similarity
+    float selfTransition = 0.95f;     // probability of keeping the same chord on the next frame
+    float silenceThreshold = 1e-4f;   // mean frame power below which the frame counts as silence
+    std::size_t smoothingLag = 32;    // frames held back before a decision is final
+};
+
+struct AudioChordResult {
+    ChordProgression progression;     // recognized chords, "N" spans left out
+    std::vector<double> startTimes;   // seconds, one per chord in progression
+    std::vector<double> endTimes;
+};
+
+class ChromaChordRecognizer {
+public:
+    ChromaChordRecognizer(double sampleRate, const ChromaOptions& options = ChromaOptions());
+
+    // Feed mono samples; complete frames are analyzed as soon as they are available
+    void push(const float* samples, std::size_t count);
+    // Flush the remaining frames and the smoothing window
+    void finish();
+
+    // Chords decided so far (all of them once finish() has been called)
+    const AudioChordResult& result() const;
+    // Move the decided chords out, e.g. to stream them while audio keeps coming
+    AudioChordResult takeResult();
+
+    // Vocabulary: 0 is "N", entry i > 0 is root (i - 1) / qualities with quality (i - 1) % qualities
+    std::size_t vocabularySize() const;
+    std::string vocabularySymbol(std::size_t index) const;
+
+    // 12-bin chroma of the most recent frame (L2-normalized, zero for silence)
+    const float* lastChroma() const;
+
+private:
+    double m_sampleRate;
+    ChromaOptions m_options;
+    std::size_t m_size;
+
+    // Analysis
+    std::vector<float> m_window;
+    std::vector<std::complex<float>> m_twiddles;
+    std::vector<std::uint32_t> m_bitReverse;
+    std::vector<int> m_binClass;      // pitch class per FFT bin, -1 outside the range
+    std::vector<float> m_samples;     // pending input, less than one frame after analysis
+    std::vector<std::complex<float>> m_spectrum;
+    float m_chroma[12] = {};
+    std::vector<float> m_templates;   // size x 12, L2-normalized
+    std::vector<float> m_emission;
+
+    // Fixed-lag Viterbi
+    std::vector<float> m_delta;
+    std::vector<float> m_nextDelta;
+    std::deque<std::vector<std::uint16_t>> m_backPointers;
+    std::size_t m_frameIndex = 0;     // frames analyzed
+    std::size_t m_decided = 0;        // frames emitted
+    std::size_t m_samplesSeen = 0;
+
+    // Output
+    AudioChordResult m_result;
+    std::size_t m_currentState = 0;
+    std::size_t m_currentStart = 0;   // frame where the current state began
+    bool m_haveCurrent = false;
+    bool m_finished = false;
+
+    void analyzeFrame();
+    void fft();
+    void emitOldest(std::size_t bestState);
+    void emitState(std::size_t state);
+    void closeSegment(double endTime);
+    double frameTime(std::size_t frame) const;
+};
+
+// Recognize the chords of one WAV file, reading it in blocks
+AudioChordResult recognizeChordsFromWav(const std::string& path, const ChromaOptions& options = ChromaOptions());
+
+// Many files at once, spread over 'threads' workers (0 = hardware concurrency)
+std::vector<AudioChordResult> recognizeChordsBatch(const std::vector<std::string>& paths,
+                                                   const ChromaOptions& options = ChromaOptions(),
+                                                   unsigned threads = 0);
@@ -3,19 +3,30 @@
 #include "Utils.hpp"
 #include "QualityManager.hpp"
 #include "Constants.hpp"
+#include "Diatonic.hpp"
+#include "Metrics.hpp"
+#include "Spelling.hpp"
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
 
-Chord::Chord(const std::string& chordName)
-    : m_chordName(chordName)
+Chord::Chord(const std::string& chordName, const allocator_type& alloc)
+    : Chord(chordName, QualityManager::Instance(), alloc)
+{
+}
+
+Chord::Chord(const std::string& chordName, const QualityManager& qualities, const allocator_type& alloc)
+    : m_chordName(chordName.begin(), chordName.end(), alloc),
+      m_root(alloc),
+      m_appended(alloc),
+      m_on(alloc)
 {
     // parse
     ChordTokens tokens = parseChord(chordName);
     m_root    = tokens.root;
-    // get a new Quality from manager
-    m_quality = QualityManager::Instance().getQuality(tokens.qualityName, tokens.inversion);
-    m_appended = tokens.appended;
+    // get a new Quality from manager, in our memory resource
+    m_quality = qualities.getQuality(tokens.qualityName, tokens.inversion, alloc);
+    m_appended.assign(tokens.appended.begin(), tokens.appended.end());
     m_on      = tokens.slashNote;
 
     // Possibly adjust slash chord intervals
@@ -25,10 +36,91 @@ Chord::Chord(const std::string& chordName)
     reconfigureChord();
 }
 
+Chord::Chord(const allocator_type& alloc)
+    : m_chordName(alloc),
+      m_root(alloc),
+      m_appended(alloc),
+      m_on(alloc)
+{
+}
+
+Chord::Chord(const Chord& other, const allocator_type& alloc)
+    : m_chordName(other.m_chordName, alloc),
+      m_root(other.m_root, alloc),
+      m_appended(other.m_appended, alloc),
+      m_on(other.m_on, alloc)
+{
+    adoptQuality(other.m_quality);
+}
+
+Chord::Chord(Chord&& other) noexcept
+    : m_chordName(std::move(other.m_chordName)),
+      m_root(std::move(other.m_root)),
+      m_quality(std::move(other.m_quality)),
+      m_appended(std::move(other.m_appended)),
+      m_on(std::move(other.m_on))
+{
+}
+
+Chord::Chord(Chord&& other, const allocator_type& alloc)
+    : m_chordName(std::move(other.m_chordName), alloc),
+      m_root(std::move(other.m_root), alloc),
+      m_appended(std::move(other.m_appended), alloc),
+      m_on(std::move(other.m_on), alloc)
+{
+    if (alloc == other.get_allocator()) {
+        m_quality = std::move(other.m_quality);
+    } else {
+        adoptQuality(other.m_quality);
+    }
+}
+
+Chord& Chord::operator=(const Chord& other) {
+    if (this != &other) {
+        // pmr members keep their own resource on assignment
+        m_chordName = other.m_chordName;
+        m_root = other.m_root;
+        m_appended = other.m_appended;
+        m_on = other.m_on;
+        adoptQuality(other.m_quality);
+    }
+    return *this;
+}
+
+Chord& Chord::operator=(Chord&& other) {
+    if (this != &other) {
+        bool sameResource = (get_allocator() == other.get_allocator());
+        m_chordName = std::move(other.m_chordName);
+        m_root = std::move(other.m_root);
+        m_appended = std::move(other.m_appended);
+        m_on = std::move(other.m_on);
+        if (sameResource) {
+            m_quality = std::move(other.m_quality);
+        } else {
+            adoptQuality(other.m_quality);
+        }
+    }
+    return *this;
+}
+
+void Chord::adoptQuality(const std::shared_ptr<Quality>& quality) {
+    if (!quality || quality->get_allocator() == get_allocator()) {
+        m_quality = quality;
+        return;
+    }
+    std::pmr::polymorphic_allocator<Quality> qualityAlloc(get_allocator());
+    m_quality = std::allocate_shared<Quality>(qualityAlloc, *quality);
+}
+
+Chord::allocator_type Chord::get_allocator() const {
+    return m_chordName.get_allocator();
+}
+
 /**
  * Similar to the Python code: from_note_index(note, quality, scale, diatonic, chromatic).
  * E.g. if you want the I chord of "Cmaj", note=1 => "C" => "C{quality}".
- * If diatonic, we deduce chord quality from the scale's scale degrees.
+ * If diatonic, we deduce chord quality from the scale's scale degrees,
+ * using the precomputed tables in Diatonic.cpp.
  */
 Chord Chord::fromNoteIndex(int note,
                            const std::string& quality,
@@ -40,108 +132,98 @@ Chord Chord::fromNoteIndex(int note,
         throw std::runtime_error("Invalid scale degree (must be 1..7 or 8).");
     }
 
-    // We'll parse the scale: last 3 chars is the mode, e.g. "maj" or "min"
-    if (scale.size() < 4) {
-        throw std::runtime_error("Scale must be something like Cmaj or Amin, e.g. length>=4");
-    }
-    std::string scaleMode = scale.substr(scale.size() - 3);
-    std::string scaleRoot = scale.substr(0, scale.size() - 3);
-
-    // check if scaleMode in RELATIVE_KEY_DICT
-    auto it = RELATIVE_KEY_DICT.find(scaleMode);
-    if (it == RELATIVE_KEY_DICT.end()) {
-        throw std::runtime_error("Unknown scale mode: " + scaleMode);
-    }
-    const auto& pattern = it->second; // scale degrees
+    // Split "Cmaj" into root "C" and mode index of "maj"
+    std::string scaleRoot;
+    int mode = 0;
+    parseScale(scale, scaleRoot, mode);
 
-    // scale degree index = note-1 => pattern[note-1]
-    int semitoneOffset = pattern[note - 1];
+    // add chromatic shift to the scale root
+    int scaleRootVal = noteToVal(scaleRoot) + chromatic;
 
-    // Now figure out the "root" semitone for the scale root
-    int scaleRootVal = noteToVal(scaleRoot);
-    // add chromatic shift
-    scaleRootVal += chromatic;
-    // overall absolute semitone
-    int chordRootVal = scaleRootVal + semitoneOffset;
-
-    // convert chordRootVal back to a note name
-    std::string chordRoot = valToNote(chordRootVal, scaleRoot);
+    // Diatonic: triad or seventh from the scale's own steps
+    bool isSeventh = false;
+    if (quality.find("7") != std::string::npos) {
+        isSeventh = true;
+    }
+    const DiatonicChord& dc = diatonicChord(scaleRootVal, mode, note, isSeventh);
 
-    // If diatonic is true, we auto-generate the chord quality from triads or sevenths
-    // as the python code does. We'll do a minimal approach:
-    std::string finalQuality = quality; // default
+    // convert the chord root back to a note name
+    std::string chordRoot = valToNote(dc.root, scaleRoot);
 
     if (diatonic) {
-        // we figure out a triad or 7th from the scale pattern. This is simplified logic:
-        // For example, we can gather intervals: (root, third, fifth, maybe seventh)
-        // then see if there's a matching chord in the manager.
-
-        // Let's build a mini chord from the scale steps:
-        // indices in pattern => (note-1), (note+1), (note+3), ...
-        // note that we have to wrap around the pattern if needed
-        // We do a naive approach:
-        // For triad: pattern[(note-1)], pattern[(note+1) % 7], pattern[(note+3) % 7]
-        // For seventh: pattern[(note+5) % 7], etc.
-        // Then we unify them to 0-based intervals. Then we see if we can find a matching quality.
-
-        // We'll handle only triad or seventh as the Python code states.
-
-        bool isSeventh = false;
-        if (quality.find("7") != std::string::npos || quality == "M7" || quality == "maj7" || quality == "m7") {
-            isSeventh = true;
-        }
-        // Gather
-        std::vector<int> diatonicIntervals;
-        diatonicIntervals.reserve(isSeventh ? 4 : 3);
+        return fromParts(chordRoot, dc.qualityName);
+    }
 
-        auto wrap = [&](int x) { return pattern[x % 7] + 12 * (x / 7); };
+    // Now construct the chord string "root + quality"
+    std::string chordExpression = chordRoot + quality;
+    return Chord(chordExpression);
+}
 
-        diatonicIntervals.push_back(wrap(note - 1));
-        diatonicIntervals.push_back(wrap((note - 1) + 2));
-        diatonicIntervals.push_back(wrap((note - 1) + 4));
-        if (isSeventh) {
-            diatonicIntervals.push_back(wrap((note - 1) + 6));
-        }
+Chord Chord::fromParts(const std::string& root,
+                       const std::string& qualityName,
+                       const std::string& on,
+                       const allocator_type& alloc)
+{
+    return fromParts(root, qualityName, on, QualityManager::Instance(), alloc);
+}
 
-        // Now reorder them so the first is 0
-        // subtract diatonicIntervals[0]
-        int base = diatonicIntervals[0];
-        for (auto &v : diatonicIntervals) {
-            v -= base;
-        }
-        // Look up in manager
-        auto found = QualityManager::Instance().findQualityFromComponents(diatonicIntervals);
-        if (!found) {
-            throw std::runtime_error("Diatonic chord not found for scale " + scale);
-        }
-        finalQuality = found->getQualityName();
+Chord Chord::fromParts(const std::string& root,
+                       const std::string& qualityName,
+                       const std::string& on,
+                       const QualityManager& qualities,
+                       const allocator_type& alloc)
+{
+    // validate notes the same way parseChord does
+    noteToVal(root);
+    if (!on.empty()) {
+        noteToVal(on);
     }
 
-    // Now construct the chord string "root + finalQuality"
-    std::string chordExpression = chordRoot + finalQuality;
-    return Chord(chordExpression);
+    Chord chord(alloc);
+    chord.m_root = root;
+    chord.m_quality = qualities.getQuality(qualityName, 0, alloc);
+    chord.m_on = on;
+    chord.applyOnChord();
+    chord.reconfigureChord();
+    return chord;
 }
 
 std::string Chord::chordName() const {
-    return m_chordName;
+    return std::string(m_chordName);
 }
 
 std::string Chord::root() const {
-    return m_root;
+    return std::string(m_root);
 }
 
-std::shared_ptr<Quality> Chord::quality() const {
+const std::shared_ptr<Quality>& Chord::quality() const {
     return m_quality;
 }
 
 std::vector<std::string> Chord::appended() const {
-    return m_appended;
+    return std::vector<std::string>(m_appended.begin(), m_appended.end());
 }
 
 std::string Chord::on() const {
+    return std::string(m_on);
+}
+
+std::string_view Chord::chordNameView() const {
+    return m_chordName;
+}
+
+std::string_view Chord::rootView() const {
+    return m_root;
+}
+
+std::string_view Chord::onView() const {
     return m_on;
 }
 
+const std::pmr::vector<std::pmr::string>& Chord::appendedView() const {
+    return m_appended;
+}
+
 std::string Chord::info() const {
     std::ostringstream oss;
     oss << m_chordName << "\n"
@@ -159,6 +241,7 @@ std::string Chord::info() const {
 }
 
 void Chord::transpose(int semitones, const std::string& scale) {
+    CYCHORD_METRIC_TIMER(Metric::Transpose);
     if (semitones == 0) return;
     // transpose root, on chord
     m_root = transposeNote(m_root, semitones, scale);
@@ -195,19 +278,51 @@ std::vector<std::string> Chord::componentsWithPitch(int rootPitch) const {
     auto compsAbs = m_quality->getComponents(m_root, false);
     std::vector<std::string> result;
     result.reserve(compsAbs.size());
+    // Tones are spelled by their degree above the root letter, so Abm gives Cb rather than B
+    const SpelledNote root = parseSpelledNote(m_root);
+    const int rootVal = noteToVal(m_root);
+    unsigned mask = 0;
     for (int semitone : compsAbs) {
-        // semitone might be negative if it's a slash chord that forced a negative offset
-        // We'll do a naive approach: figure out how many 12's fit below or above rootPitch
-        // But let's match the python approach exactly:
-        // "val_to_note(c, scale=self._root) + std::to_string(root_pitch + c // 12)"
-        int octaveOffset = rootPitch + semitone / 12;
-        int noteVal = semitone;
-        std::string noteName = valToNote(noteVal, m_root);
-        result.push_back(noteName + std::to_string(octaveOffset));
+        mask |= 1u << (((semitone - rootVal) % 12 + 12) % 12);
+    }
+    for (int semitone : compsAbs) {
+        // The octave follows the spelled letter, not the pitch: Cb5 sounds as B4 (71), B#4 as C5 (72)
+        const std::string& name = spellChordTone(root, mask, semitone - rootVal);
+        const int midi = (rootPitch + 1) * 12 + semitone;
+        const int natural = midi - parseSpelledNote(name).accidental;
+        const int octave = (natural >= 0 ? natural / 12 : (natural - 11) / 12) - 1;
+        result.push_back(name + std::to_string(octave));
     }
     return result;
 }
 
+std::size_t Chord::componentCount() const {
+    return m_quality ? m_quality->getIntervals().size() : 0;
+}
+
+std::size_t Chord::pitches(int rootOctave, int* out, std::size_t capacity) const {
+    std::size_t count = componentCount();
+    if (count > capacity) {
+        throw std::runtime_error("Output buffer too small in Chord::pitches.");
+    }
+    pitches(rootOctave, out);
+    return count;
+}
+
+unsigned Chord::pitchClassMask() const {
+    unsigned mask = 0;
+    int root = noteToVal(m_root);
+    for (int interval : m_quality->getIntervals()) {
+        mask |= 1u << (((root + interval) % 12 + 12) % 12);
+    }
+    return mask;
+}
+
+int Chord::rootMidi(int rootOctave) const {
+    // C4 = 60; a slash note below the root may land in the octave beneath
+    return 12 * (rootOctave + 1) + noteToVal(m_root);
+}
+
 bool Chord::operator==(const Chord& other) const {
     // Compare roots by semitone, so e.g. "C" == "B#" is the same
     if (noteToVal(m_root) != noteToVal(other.m_root)) {
@@ -252,14 +367,17 @@ bool Chord::operator==(const Chord& other) const {
 }
 
 void Chord::reconfigureChord() {
-    // Rebuild textual name from pieces
-    std::string qName = m_quality ? m_quality->getQualityName() : "";
-    // appended
-    std::string appended = displayAppended(m_appended);
+    // Rebuild textual name from pieces, in place so it stays in our resource
+    m_chordName = m_root;
+    if (m_quality) {
+        m_chordName += m_quality->getQualityName();
+    }
+    // appended, joined the same way as displayAppended
+    for (const auto& app : m_appended) {
+        m_chordName += app;
+    }
     // slash
-    std::string slash = displayOn(m_on);
-
-    m_chordName = m_root + qName + appended + slash;
+    m_chordName += displayOn(m_on);
 }
 
 void Chord::applyOnChord() {
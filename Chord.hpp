@@ -1,18 +1,43 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
 #include "Quality.hpp"
 
+class QualityManager;
+
 /**
  * Represents a chord. e.g. "F#m7-5/A".
+ *
+ * Allocator-aware (std::pmr): strings, appended notes and the Quality with its
+ * shared_ptr control block all come from the chord's memory resource.
+ * As with the standard pmr containers, plain copies go to the default resource
+ * and copies with an explicit allocator go to that one.
  */
 
 class Chord {
 public:
-    // Constructor from a chord string
-    explicit Chord(const std::string& chordName);
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    // Constructor from a chord string; qualities come from QualityManager::Instance()
+    explicit Chord(const std::string& chordName, const allocator_type& alloc = allocator_type());
+    // Same, resolving the quality in the given registry
+    Chord(const std::string& chordName, const QualityManager& qualities,
+          const allocator_type& alloc = allocator_type());
+
+    // Copy / move, optionally into another memory resource
+    Chord(const Chord& other, const allocator_type& alloc = allocator_type());
+    Chord(Chord&& other) noexcept;
+    Chord(Chord&& other, const allocator_type& alloc);
+    Chord& operator=(const Chord& other);
+    Chord& operator=(Chord&& other);
 
     // Alternate constructor from python code: from_note_index
     static Chord fromNoteIndex(int note,
@@ -21,13 +46,35 @@ public:
                                bool diatonic = false,
                                int chromatic = 0);
 
+    /**
+     * Build a chord from already-split pieces, e.g. ("F#", "m7", "A").
+     * Skips parseChord entirely; used by the batch harmonization paths.
+     */
+    static Chord fromParts(const std::string& root,
+                           const std::string& qualityName,
+                           const std::string& on = "",
+                           const allocator_type& alloc = allocator_type());
+    static Chord fromParts(const std::string& root,
+                           const std::string& qualityName,
+                           const std::string& on,
+                           const QualityManager& qualities,
+                           const allocator_type& alloc = allocator_type());
+
     // Inspectors
     std::string chordName() const;  // full chord name
     std::string root() const;
-    std::shared_ptr<Quality> quality() const;
+    const std::shared_ptr<Quality>& quality() const;
     std::vector<std::string> appended() const;
     std::string on() const;
 
+    // Copy-free inspectors; valid while the chord is alive and unchanged
+    std::string_view chordNameView() const;
+    std::string_view rootView() const;
+    std::string_view onView() const;
+    const std::pmr::vector<std::pmr::string>& appendedView() const;
+
+    allocator_type get_allocator() const;
+
     // Info
     std::string info() const;
 
@@ -39,25 +86,92 @@ public:
 
     /**
      * Return the chord's pitches, e.g. ["C4","E4","G4"] if root_pitch=4
-     * (though we store pitch as the "octave" notion).
+     * (though we store pitch as the "octave" notion). The octave number goes
+     * with the spelled letter: "Abm" gives Ab4 Cb5 Eb5, "C#maj7" ends on B#4.
      */
     std::vector<std::string> componentsWithPitch(int rootPitch) const;
 
+    /**
+     * Allocation-free variants for playback. Number of notes the chord produces,
+     * i.e. how many values components()/pitches() below will write.
+     */
+    std::size_t componentCount() const;
+
+    /**
+     * Write the 0-based sorted intervals (same values as components()) into 'out'.
+     * Returns the iterator past the last written value.
+     */
+    template <class OutputIt>
+    OutputIt components(OutputIt out) const;
+
+    /**
+     * Write MIDI note numbers into 'out', in the same order as componentsWithPitch().
+     * The root is placed in 'rootOctave' (C4 = 60), so "Am" with rootOctave=4 gives 69,72,76.
+     */
+    template <class OutputIt>
+    OutputIt pitches(int rootOctave, OutputIt out) const;
+
+    /**
+     * Bounded variant: writes at most 'capacity' notes, throws if the chord does not fit.
+     * Returns the number of notes written.
+     */
+    std::size_t pitches(int rootOctave, int* out, std::size_t capacity) const;
+
+    // Pitch classes sounding in the chord as a 12-bit mask (bit 0 = C)
+    unsigned pitchClassMask() const;
+
     // Operators
     bool operator==(const Chord& other) const;
     bool operator!=(const Chord& other) const { return !(*this == other); }
 
+    // Upper bound on the number of notes handled by the allocation-free overloads
+    static constexpr std::size_t MAX_COMPONENTS = 32;
+
 private:
+    explicit Chord(const allocator_type& alloc); // for fromParts
+
     // data
-    std::string m_chordName;             // e.g. "F#m7-5/A"
-    std::string m_root;                  // e.g. "F#"
-    std::shared_ptr<Quality> m_quality;  // e.g. "m7-5"
-    std::vector<std::string> m_appended; // appended notes
-    std::string m_on;                    // slash note
+    std::pmr::string m_chordName;                  // e.g. "F#m7-5/A"
+    std::pmr::string m_root;                       // e.g. "F#"
+    std::shared_ptr<Quality> m_quality;            // e.g. "m7-5"
+    std::pmr::vector<std::pmr::string> m_appended; // appended notes
+    std::pmr::string m_on;                         // slash note
 
 private:
     // Reconstruct m_chordName from pieces
     void reconfigureChord();
     // Adjust the Quality for slash chord
     void applyOnChord();
+    // MIDI number of the root in the given octave
+    int rootMidi(int rootOctave) const;
+    // Share 'quality' if it already lives in our resource, else copy it over
+    void adoptQuality(const std::shared_ptr<Quality>& quality);
 };
+
+template <class OutputIt>
+OutputIt Chord::components(OutputIt out) const {
+    const auto& intervals = m_quality->getIntervals();
+    if (intervals.size() > MAX_COMPONENTS) {
+        throw std::runtime_error("Too many chord components for Chord::components(out).");
+    }
+    // Sort on the stack rather than in a fresh vector
+    std::array<int, MAX_COMPONENTS> sorted;
+    std::copy(intervals.begin(), intervals.end(), sorted.begin());
+    auto last = sorted.begin() + intervals.size();
+    std::sort(sorted.begin(), last);
+    if (sorted.begin() == last) return out;
+    int base = sorted[0];
+    for (auto it = sorted.begin(); it != last; ++it) {
+        *out++ = *it - base;
+    }
+    return out;
+}
+
+template <class OutputIt>
+OutputIt Chord::pitches(int rootOctave, OutputIt out) const {
+    int base = rootMidi(rootOctave);
+    for (int interval : m_quality->getIntervals()) {
+        *out++ = base + interval;
+    }
+    return out;
+}
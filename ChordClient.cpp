@@ -0,0 +1,179 @@
+#include "ChordClient.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+ChordClient::ChordClient(const std::string& socketPath) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+    }
+    if (::connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::close(m_fd);
+        throw std::runtime_error("Cannot connect to " + socketPath + ": " + reason);
+    }
+}
+
+ChordClient::~ChordClient() {
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+ChordClient::ChordClient(ChordClient&& other) noexcept
+    : m_fd(std::exchange(other.m_fd, -1)),
+      m_nextId(other.m_nextId),
+      m_in(std::move(other.m_in)),
+      m_inOffset(other.m_inOffset),
+      m_out(std::move(other.m_out))
+{
+}
+
+ChordClient& ChordClient::operator=(ChordClient&& other) noexcept {
+    if (this != &other) {
+        if (m_fd >= 0) ::close(m_fd);
+        m_fd = std::exchange(other.m_fd, -1);
+        m_nextId = other.m_nextId;
+        m_in = std::move(other.m_in);
+        m_inOffset = other.m_inOffset;
+        m_out = std::move(other.m_out);
+    }
+    return *this;
+}
+
+ChordResponse ChordClient::parse(const std::string& symbol) {
+    ChordRequest request;
+    request.op = ChordOp::Parse;
+    request.payload = symbol;
+    return single(std::move(request));
+}
+
+ChordResponse ChordClient::recognize(const std::vector<int>& midiNotes) {
+    ChordRequest request;
+    request.op = ChordOp::Recognize;
+    for (int note : midiNotes) {
+        if (note < 0 || note > 127) {
+            throw std::runtime_error("MIDI note out of range: " + std::to_string(note));
+        }
+        request.payload += static_cast<char>(note);
+    }
+    return single(std::move(request));
+}
+
+ChordResponse ChordClient::transpose(const std::string& symbol, int semitones) {
+    ChordRequest request;
+    request.op = ChordOp::Transpose;
+    request.arg = static_cast<std::int16_t>(semitones);
+    request.payload = symbol;
+    return single(std::move(request));
+}
+
+ChordResponse ChordClient::single(ChordRequest request) {
+    request.id = m_nextId++;
+    m_out.clear();
+    appendChordRequest(m_out, request);
+    sendAll(m_out);
+    ChordResponse response;
+    do {
+        receive(response);
+    } while (response.id != request.id);
+    return response;
+}
+
+std::vector<ChordResponse> ChordClient::call(const std::vector<ChordRequest>& requests) {
+    const std::uint32_t first = m_nextId;
+    m_out.clear();
+    for (const auto& request : requests) {
+        ChordRequest numbered = request;
+        numbered.id = m_nextId++;
+        appendChordRequest(m_out, numbered);
+    }
+
+    // Write and read together: the server stops reading a connection whose
+    // answers pile up unread, so a blocking write of a big batch would never end.
+    // The server may answer out of order; ids are consecutive from 'first'
+    std::vector<ChordResponse> responses(requests.size());
+    std::size_t received = 0;
+    std::size_t sent = 0;
+    ChordResponse response;
+    while (received < requests.size()) {
+        pollfd ready;
+        ready.fd = m_fd;
+        ready.events = POLLIN;
+        if (sent < m_out.size()) ready.events |= POLLOUT;
+        ready.revents = 0;
+        if (::poll(&ready, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+        }
+        if (ready.revents & POLLOUT) {
+            const ssize_t n = ::send(m_fd, m_out.data() + sent, m_out.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+                throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+            }
+            if (n > 0) sent += static_cast<std::size_t>(n);
+        }
+        if (ready.revents & (POLLIN | POLLHUP | POLLERR)) {
+            readMore(MSG_DONTWAIT);
+            while (received < requests.size() && takeChordResponse(m_in, m_inOffset, response)) {
+                const std::uint32_t slot = response.id - first;
+                if (slot < requests.size()) {
+                    responses[slot] = std::move(response);
+                    ++received;
+                }
+            }
+        }
+    }
+    return responses;
+}
+
+void ChordClient::sendAll(const std::string& bytes) {
+    std::size_t sent = 0;
+    while (sent < bytes.size()) {
+        const ssize_t n = ::send(m_fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("send: ") + std::strerror(errno));
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+}
+
+void ChordClient::receive(ChordResponse& response) {
+    while (!takeChordResponse(m_in, m_inOffset, response)) {
+        readMore(0);
+    }
+}
+
+bool ChordClient::readMore(int flags) {
+    if (m_inOffset > 0) {
+        m_in.erase(0, m_inOffset);
+        m_inOffset = 0;
+    }
+    char buffer[65536];
+    ssize_t n;
+    do {
+        n = ::recv(m_fd, buffer, sizeof(buffer), flags);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (flags & MSG_DONTWAIT) && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return false;
+    }
+    if (n <= 0) {
+        throw std::runtime_error(n == 0 ? "Connection closed by server"
+                                        : std::string("recv: ") + std::strerror(errno));
+    }
+    m_in.append(buffer, static_cast<std::size_t>(n));
+    return true;
+}
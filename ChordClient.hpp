@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ChordService.hpp"
+
+/**
+ * Blocking client for ChordServer. One connection, not thread-safe: give
+ * each thread its own client. call() pipelines a whole batch of requests
+ * over the connection, reading answers as they come, which is what lets the
+ * server coalesce them.
+ */
+class ChordClient {
+public:
+    explicit ChordClient(const std::string& socketPath);
+    ~ChordClient();
+
+    ChordClient(ChordClient&& other) noexcept;
+    ChordClient& operator=(ChordClient&& other) noexcept;
+    ChordClient(const ChordClient&) = delete;
+    ChordClient& operator=(const ChordClient&) = delete;
+
+    ChordResponse parse(const std::string& symbol);
+    ChordResponse recognize(const std::vector<int>& midiNotes);
+    ChordResponse transpose(const std::string& symbol, int semitones);
+
+    /**
+     * Sends every request, then returns the responses in request order.
+     * Request ids are assigned by the client. Throws std::runtime_error if
+     * the connection fails.
+     *
+     * The server reads at most ServerOptions::maxInFlight unanswered requests
+     * (or maxPendingBytes of unread answers) ahead of the client, so call()
+     * reads answers while it is still writing. Any batch size completes; the
+     * batch and all of its answers are held in memory until it returns.
+     */
+    std::vector<ChordResponse> call(const std::vector<ChordRequest>& requests);
+
+private:
+    ChordResponse single(ChordRequest request);
+    void sendAll(const std::string& bytes);
+    void receive(ChordResponse& response);
+    // One recv into m_in; false if 'flags' has MSG_DONTWAIT and nothing was ready
+    bool readMore(int flags);
+
+    int m_fd = -1;
+    std::uint32_t m_nextId = 1;
+    std::string m_in;
+    std::size_t m_inOffset = 0;
+    std::string m_out;
+};
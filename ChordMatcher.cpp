@@ -0,0 +1,151 @@
+#include "ChordMatcher.hpp"
+#include "QualityManager.hpp"
+#include "Constants.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <stdexcept>
+
+static inline unsigned rotate12(unsigned mask, int by) {
+    return ((mask << by) | (mask >> (12 - by))) & 0xFFFu;
+}
+
+// Conventional spellings that win over every other name for their tones: the shorthands
+// "2", "4" and "sus" would print as "C2", "C4" (read as notes with an octave) and "Csus"
+static const char* const CONVENTIONAL_NAMES[] = {"add9", "add11", "sus4", "sus4add9"};
+
+static bool conventionalName(const std::string& name) {
+    return std::any_of(std::begin(CONVENTIONAL_NAMES), std::end(CONVENTIONAL_NAMES),
+                       [&](const char* conventional) { return name == conventional; });
+}
+
+// Among names with the same tones prefer the conventional spelling, then plain letters/digits
+// ("m7b5" over "m7-5"), then "maj" over a leading "M" ("maj7" over "M7", as the diatonic
+// tables spell it), then short ones
+static bool preferName(const std::string& a, const std::string& b) {
+    const bool ca = conventionalName(a), cb = conventionalName(b);
+    if (ca != cb) return ca;
+    auto punct = [](const std::string& s) {
+        return std::count_if(s.begin(), s.end(), [](unsigned char c) { return !std::isalnum(c); });
+    };
+    auto pa = punct(a), pb = punct(b);
+    if (pa != pb) return pa < pb;
+    const bool ma = !a.empty() && a[0] == 'M', mb = !b.empty() && b[0] == 'M';
+    if (ma != mb) return mb;
+    if (a.size() != b.size()) return a.size() < b.size();
+    return a < b;
+}
+
+ChordMatcher::ChordMatcher(const MatcherWeights& weights)
+    : ChordMatcher(weights, QualityManager::Instance())
+{
+}
+
+ChordMatcher::ChordMatcher(const MatcherWeights& weights, const QualityManager& qualities)
+    : m_weights(weights), m_qualities(qualities)
+{
+    // Defaults first, in their usual order, then the qualities this registry adds
+    std::vector<std::string> names;
+    for (const auto& entry : DEFAULT_QUALITIES) {
+        if (qualities.hasQuality(entry.first)) names.push_back(entry.first);
+    }
+    for (auto& name : qualities.qualityNames()) {
+        if (std::none_of(DEFAULT_QUALITIES.begin(), DEFAULT_QUALITIES.end(),
+                         [&](const auto& entry) { return entry.first == name; })) {
+            names.push_back(std::move(name));
+        }
+    }
+
+    for (const std::string& name : names) {
+        auto quality = qualities.getQuality(name);
+        unsigned mask = 0;
+        for (int interval : quality->getIntervals()) {
+            mask |= 1u << ((interval % 12 + 12) % 12);
+        }
+        // One candidate per distinct tone set
+        auto it = std::find(m_masks.begin(), m_masks.end(), mask);
+        if (it != m_masks.end()) {
+            std::size_t i = static_cast<std::size_t>(it - m_masks.begin());
+            if (preferName(name, m_names[i])) m_names[i] = name;
+            continue;
+        }
+        m_names.push_back(name);
+        m_masks.push_back(mask);
+        m_priors.push_back(-weights.complexity * std::max(0, popcount12(mask) - 3));
+    }
+}
+
+std::size_t ChordMatcher::match(unsigned pitchClassMask, int bass, ChordMatch* out, std::size_t k) const {
+    pitchClassMask &= 0xFFFu;
+    if (k == 0 || pitchClassMask == 0) {
+        return 0;
+    }
+    std::size_t count = 0;
+    for (int root = 0; root < 12; ++root) {
+        for (std::size_t q = 0; q < m_masks.size(); ++q) {
+            unsigned chordMask = rotate12(m_masks[q], root);
+            int missing = popcount12(chordMask & ~pitchClassMask);
+            int extra = popcount12(pitchClassMask & ~chordMask);
+            float score = m_priors[q]
+                        - m_weights.missingTone * missing
+                        - m_weights.extraTone * extra;
+            if (bass >= 0) {
+                if (bass == root) {
+                    score += m_weights.rootInBass;
+                } else if (!(chordMask & (1u << bass))) {
+                    score -= m_weights.bassNotInChord;
+                }
+            }
+
+            // Keep the top k in 'out', best first (k is small: insertion is cheapest)
+            if (count == k && score <= out[k - 1].score) continue;
+            std::size_t pos = (count < k) ? count++ : k - 1;
+            while (pos > 0 && out[pos - 1].score < score) {
+                out[pos] = out[pos - 1];
+                --pos;
+            }
+            out[pos] = ChordMatch{root, bass, q, score, missing, extra};
+        }
+    }
+    return count;
+}
+
+std::vector<ChordMatch> ChordMatcher::match(const std::vector<int>& midiNotes, std::size_t k) const {
+    std::vector<ChordMatch> result(k);
+    if (midiNotes.empty()) {
+        return {};
+    }
+    unsigned mask = 0;
+    for (int note : midiNotes) {
+        mask |= 1u << (((note % 12) + 12) % 12);
+    }
+    int lowest = *std::min_element(midiNotes.begin(), midiNotes.end());
+    result.resize(match(mask, ((lowest % 12) + 12) % 12, result.data(), k));
+    return result;
+}
+
+std::size_t ChordMatcher::vocabularySize() const {
+    return m_names.size();
+}
+
+const std::string& ChordMatcher::qualityName(std::size_t quality) const {
+    if (quality >= m_names.size()) {
+        throw std::runtime_error("Index out of range in ChordMatcher::qualityName.");
+    }
+    return m_names[quality];
+}
+
+long ChordMatcher::findQuality(unsigned relativeMask) const {
+    auto it = std::find(m_masks.begin(), m_masks.end(), relativeMask & 0xFFFu);
+    return it == m_masks.end() ? -1 : static_cast<long>(it - m_masks.begin());
+}
+
+Chord ChordMatcher::toChord(const ChordMatch& match, const std::string& scale) const {
+    std::string root = valToNote(match.root, scale);
+    std::string on;
+    if (match.bass >= 0 && match.bass != match.root) {
+        on = valToNote(match.bass, scale);
+    }
+    return Chord::fromParts(root, qualityName(match.quality), on, m_qualities);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Chord.hpp"
+#include "QualityManager.hpp"
+
+/**
+ * Ranked chord recognition. Unlike findQualityFromComponents, which returns the
+ * first name that matches in map order, every (root, quality) candidate is
+ * scored by weighted missing and extra tones, bass placement and a quality
+ * prior, using popcounts over 12-bit pitch-class masks.
+ */
+
+struct MatcherWeights {
+    float missingTone = 1.0f;   // per chord tone not played
+    float extraTone = 1.5f;     // per played note outside the chord
+    float rootInBass = 0.5f;    // bonus when the lowest note is the root
+    float bassNotInChord = 1.0f;// penalty when the lowest note is not a chord tone
+    float complexity = 0.15f;   // prior: per chord tone beyond a triad
+};
+
+struct ChordMatch {
+    int root;                 // pitch class
+    int bass;                 // pitch class of the lowest note, -1 if unknown
+    std::size_t quality;      // index into the matcher's vocabulary
+    float score;              // higher is better
+    int missing;              // chord tones not played
+    int extra;                // played notes outside the chord
+};
+
+class ChordMatcher {
+public:
+    // Snapshot of the qualities registered in QualityManager::Instance() at construction
+    explicit ChordMatcher(const MatcherWeights& weights = MatcherWeights());
+    // Snapshot of the qualities registered in 'qualities' at construction
+    ChordMatcher(const MatcherWeights& weights, const QualityManager& qualities);
+
+    /**
+     * Best 'k' candidates for a pitch-class mask (bit 0 = C) and bass pitch class
+     * (-1 if unknown), best first, written to 'out'. Does not allocate.
+     * Returns the number written (at most k).
+     */
+    std::size_t match(unsigned pitchClassMask, int bass, ChordMatch* out, std::size_t k) const;
+
+    // Convenience form for MIDI notes; the lowest note is taken as the bass
+    std::vector<ChordMatch> match(const std::vector<int>& midiNotes, std::size_t k = 5) const;
+
+    std::size_t vocabularySize() const;
+    const std::string& qualityName(std::size_t quality) const;
+    // Vocabulary entry for a root-relative pitch-class mask, or -1
+    long findQuality(unsigned relativeMask) const;
+
+    // Build the Chord for a match; a bass other than the root becomes a slash note
+    Chord toChord(const ChordMatch& match, const std::string& scale = "C") const;
+
+private:
+    MatcherWeights m_weights;
+    QualityManager m_qualities;     // shares the registry's table, for toChord
+    std::vector<std::string> m_names;
+    std::vector<unsigned> m_masks;  // pitch-class mask relative to the root
+    std::vector<float> m_priors;
+};
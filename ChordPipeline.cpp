@@ -0,0 +1,216 @@
+#include "ChordPipeline.hpp"
+#include "BoundedQueue.hpp"
+#include "Constants.hpp"
+#include "Diatonic.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <thread>
+#include <vector>
+
+ChordLineProcessor::ChordLineProcessor(const PipelineOptions& options)
+    : m_options(options)
+{
+    // Every default name maps to the matcher's preferred name for the same tones
+    for (const auto& entry : DEFAULT_QUALITIES) {
+        unsigned mask = 0;
+        for (int interval : entry.second) mask |= 1u << (((interval % 12) + 12) % 12);
+        const long q = m_matcher.findQuality(mask);
+        if (q >= 0) {
+            m_canonical[entry.first] = m_matcher.qualityName(static_cast<std::size_t>(q));
+        }
+    }
+    if (!options.key.empty()) {
+        std::string root;
+        parseScale(options.key, root, m_keyMode);
+        m_keyRoot = noteToVal(root);
+    }
+}
+
+bool ChordLineProcessor::transform(Chord& chord, std::string& out) const {
+    if (m_options.transpose != 0) {
+        chord.transpose(m_options.transpose, m_options.scale);
+    }
+    if (m_options.normalize) {
+        auto it = m_canonical.find(chord.quality()->getQualityName());
+        if (it != m_canonical.end() && it->first != it->second) {
+            chord = Chord::fromParts(chord.root(), it->second, chord.on());
+        }
+    }
+    out += chord.chordNameView();
+
+    if (m_options.analyze) {
+        int notes[Chord::MAX_COMPONENTS];
+        const std::size_t n = chord.pitches(4, notes, Chord::MAX_COMPONENTS);
+        out += '[';
+        for (std::size_t i = 0; i < n; ++i) {
+            if (i) out += ' ';
+            out += valToNote(notes[i] % 12, m_options.scale);
+        }
+        out += ']';
+    }
+    if (!m_options.key.empty()) {
+        out += '{';
+        out += romanNumeral(chord, m_keyRoot, m_keyMode);
+        out += '}';
+    }
+    return true;
+}
+
+void ChordLineProcessor::process(const std::string& line, std::string& out, PipelineStats& stats) const {
+    ++stats.lines;
+
+    // Tokens: runs of non-space characters, with every '|' a token of its own
+    std::vector<std::pair<std::size_t, std::size_t>> tokens;
+    bool numeric = true;
+    std::size_t chordTokens = 0;
+    for (std::size_t i = 0; i < line.size();) {
+        const unsigned char c = static_cast<unsigned char>(line[i]);
+        if (std::isspace(c)) {
+            ++i;
+            continue;
+        }
+        std::size_t end = i + 1;
+        if (c != '|') {
+            while (end < line.size() && line[end] != '|' && !std::isspace(static_cast<unsigned char>(line[end]))) ++end;
+            ++chordTokens;
+            numeric = numeric && std::all_of(line.begin() + i, line.begin() + end,
+                                             [](char ch) { return std::isdigit(static_cast<unsigned char>(ch)); });
+        }
+        tokens.emplace_back(i, end - i);
+        i = end;
+    }
+
+    auto emit = [&](Chord chord) {
+        ++stats.chords;
+        std::size_t mark = out.size();
+        try {
+            if (transform(chord, out)) return;
+        } catch (const std::exception&) {
+        }
+        out.resize(mark);
+        out += '?';
+        ++stats.errors;
+    };
+
+    // A line of MIDI note numbers is one chord
+    if (chordTokens > 0 && numeric) {
+        std::vector<int> notes;
+        try {
+            for (const auto& t : tokens) {
+                if (line[t.first] != '|') notes.push_back(std::stoi(line.substr(t.first, t.second)));
+            }
+        } catch (const std::exception&) {
+            notes.clear();  // out of range
+        }
+        auto best = notes.empty() ? std::vector<ChordMatch>() : m_matcher.match(notes, 1);
+        if (!best.empty()) {
+            emit(m_matcher.toChord(best[0], m_options.scale));
+        } else {
+            ++stats.chords;
+            ++stats.errors;
+            out += '?';
+        }
+        return;
+    }
+
+    bool first = true;
+    for (const auto& t : tokens) {
+        if (!first) out += ' ';
+        first = false;
+        if (line[t.first] == '|') {
+            out += '|';
+            continue;
+        }
+        std::string symbol = line.substr(t.first, t.second);
+        try {
+            emit(Chord(symbol));
+        } catch (const std::exception&) {
+            ++stats.chords;
+            ++stats.errors;
+            out += '?';
+        }
+    }
+}
+
+PipelineStats runChordPipeline(std::istream& in, std::ostream& out, const PipelineOptions& options) {
+    struct Result {
+        std::string text;
+        PipelineStats stats;
+    };
+    struct Batch {
+        std::vector<std::string> lines;
+        std::promise<Result> result;
+    };
+
+    const ChordLineProcessor processor(options);
+    unsigned workers = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t batchLines = std::max<std::size_t>(1, options.batchLines);
+
+    // Batches go to the workers in any order, while their futures queue up in
+    // input order for the writer; both queues are bounded
+    BoundedQueue<Batch> work(options.queueDepth);
+    BoundedQueue<std::future<Result>> ordered(options.queueDepth + workers);
+
+    std::thread reader([&] {
+        Batch batch;
+        std::string line;
+        auto flush = [&] {
+            Batch next;
+            next.lines.reserve(batchLines);
+            std::swap(batch, next);
+            return ordered.push(next.result.get_future()) && work.push(std::move(next));
+        };
+        while (std::getline(in, line)) {
+            batch.lines.push_back(std::move(line));
+            if (batch.lines.size() == batchLines && !flush()) break;
+        }
+        if (!batch.lines.empty()) flush();
+        work.close();
+        ordered.close();
+    });
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; ++w) {
+        pool.emplace_back([&] {
+            Batch batch;
+            while (work.pop(batch)) {
+                try {
+                    Result result;
+                    for (const auto& line : batch.lines) {
+                        processor.process(line, result.text, result.stats);
+                        result.text += '\n';
+                    }
+                    batch.result.set_value(std::move(result));
+                } catch (...) {
+                    batch.result.set_exception(std::current_exception());
+                }
+            }
+        });
+    }
+
+    PipelineStats total;
+    std::exception_ptr error;
+    std::future<Result> next;
+    while (ordered.pop(next)) {
+        try {
+            Result result = next.get();
+            out.write(result.text.data(), static_cast<std::streamsize>(result.text.size()));
+            total.lines += result.stats.lines;
+            total.chords += result.stats.chords;
+            total.errors += result.stats.errors;
+        } catch (...) {
+            error = std::current_exception();
+            work.close();
+            ordered.close();
+            break;
+        }
+    }
+    reader.join();
+    for (auto& t : pool) t.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return total;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include "ChordMatcher.hpp"
+
+/**
+ * Line-oriented chord processing shared by the command-line tool.
+ *
+ * An input line is either chord symbols separated by whitespace and/or bar
+ * lines ("| Dm7 G7 | Cmaj7 |"), or a list of MIDI note numbers ("60 64 67"),
+ * which is recognized as one chord. Each chord is optionally transposed,
+ * normalized and analyzed; bar lines are kept, so output lines match input
+ * lines one to one. Symbols that cannot be parsed are written as "?".
+ */
+
+struct PipelineOptions {
+    int transpose = 0;           // semitones
+    std::string scale = "C";     // spelling used for transposed roots
+    bool normalize = false;      // rewrite qualities to one name per tone set ("CM7" -> "Cmaj7")
+    bool analyze = false;        // append the chord tones, e.g. "Am7[A C E G]"
+    std::string key;             // if set (e.g. "Cmaj"), also append the Roman numeral
+    unsigned workers = 0;        // parse/transform threads (0 = hardware concurrency)
+    std::size_t batchLines = 512;
+    std::size_t queueDepth = 16; // batches in flight between stages
+};
+
+struct PipelineStats {
+    std::size_t lines = 0;
+    std::size_t chords = 0;
+    std::size_t errors = 0;
+};
+
+class ChordLineProcessor {
+public:
+    explicit ChordLineProcessor(const PipelineOptions& options = PipelineOptions());
+
+    // Process one line (without its newline) and append the result to 'out'
+    void process(const std::string& line, std::string& out, PipelineStats& stats) const;
+
+private:
+    PipelineOptions m_options;
+    ChordMatcher m_matcher;
+    std::unordered_map<std::string, std::string> m_canonical;  // quality name -> preferred name
+    int m_keyRoot = 0;
+    int m_keyMode = 0;
+
+    bool transform(Chord& chord, std::string& out) const;
+};
+
+/**
+ * Stream 'in' to 'out' through read -> parse/transform -> write stages
+ * connected by bounded queues, with a worker pool for the middle stage.
+ * Output is in input order; memory stays bounded by batchLines * queueDepth.
+ */
+PipelineStats runChordPipeline(std::istream& in, std::ostream& out,
+                               const PipelineOptions& options = PipelineOptions());
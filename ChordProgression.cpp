@@ -1,38 +1,136 @@
 #include "ChordProgression.hpp"
 #include <stdexcept>
 #include <sstream>
+#include <atomic>
 
-// Helper to convert a string or chord into a Chord
-static Chord asChord(const std::string& c) {
-    return Chord(c);
+
+// Revisions are unique across all progressions, so copies that diverge never collide
+static std::uint64_t nextRevision() {
+    static std::atomic<std::uint64_t> counter(0);
+    return ++counter;
 }
-static Chord asChord(const Chord& c) {
-    return c;
+
+ChordProgression::ChordProgression()
+    : ChordProgression(allocator_type())
+{
 }
 
-ChordProgression::ChordProgression() {}
+ChordProgression::ChordProgression(const allocator_type& alloc)
+    : m_chords(alloc),
+      m_revision(nextRevision()),
+      m_baseRevision(m_revision),
+      m_edits(alloc)
+{
+}
 
-ChordProgression::ChordProgression(const std::string& singleChord) {
-    m_chords.push_back(asChord(singleChord));
+ChordProgression::ChordProgression(const std::string& singleChord, const allocator_type& alloc)
+    : ChordProgression(alloc)
+{
+    // the vector's allocator is handed to the Chord as it is constructed in place
+    m_chords.emplace_back(singleChord);
 }
 
-ChordProgression::ChordProgression(const Chord& singleChord) {
+ChordProgression::ChordProgression(const Chord& singleChord, const allocator_type& alloc)
+    : ChordProgression(alloc)
+{
     m_chords.push_back(singleChord);
 }
 
-ChordProgression::ChordProgression(const std::vector<std::string>& chordNames) {
+ChordProgression::ChordProgression(const std::vector<std::string>& chordNames, const allocator_type& alloc)
+    : ChordProgression(alloc)
+{
     m_chords.reserve(chordNames.size());
     for (auto &cn : chordNames) {
-        m_chords.push_back(asChord(cn));
+        m_chords.emplace_back(cn);
     }
 }
 
-ChordProgression::ChordProgression(const std::vector<Chord>& chords) {
-    m_chords = chords;
+ChordProgression::ChordProgression(const std::vector<Chord>& chords, const allocator_type& alloc)
+    : ChordProgression(alloc)
+{
+    m_chords.assign(chords.begin(), chords.end());
+}
+
+ChordProgression::ChordProgression(std::vector<Chord>&& chords, const allocator_type& alloc)
+    : ChordProgression(alloc)
+{
+    m_chords.reserve(chords.size());
+    for (auto& c : chords) {
+        m_chords.push_back(std::move(c));
+    }
+    chords.clear();
+}
+
+ChordProgression::ChordProgression(const ChordProgression& other, const allocator_type& alloc)
+    : m_chords(other.m_chords, alloc),
+      m_revision(other.m_revision),
+      m_baseRevision(other.m_baseRevision),
+      m_edits(other.m_edits, alloc),
+      m_logEdits(other.m_logEdits)
+{
+}
+
+ChordProgression::allocator_type ChordProgression::get_allocator() const {
+    return m_chords.get_allocator();
 }
 
 void ChordProgression::append(const Chord& chord) {
     m_chords.push_back(chord);
+    recordEdit(ProgressionEdit::Insert, m_chords.size() - 1, 1);
+}
+
+void ChordProgression::append(Chord&& chord) {
+    m_chords.push_back(std::move(chord));
+    recordEdit(ProgressionEdit::Insert, m_chords.size() - 1, 1);
+}
+
+Chord& ChordProgression::emplace_back(const std::string& symbol) {
+    m_chords.emplace_back(symbol);
+    recordEdit(ProgressionEdit::Insert, m_chords.size() - 1, 1);
+    return m_chords.back();
+}
+
+Chord& ChordProgression::emplace(std::size_t index, const std::string& symbol) {
+    if (index > m_chords.size()) {
+        throw std::runtime_error("Index out of range in ChordProgression::emplace.");
+    }
+    auto it = m_chords.emplace(m_chords.begin() + index, symbol);
+    recordEdit(ProgressionEdit::Insert, index, 1);
+    return *it;
+}
+
+void ChordProgression::extend(ChordProgression&& other) {
+    if (&other == this) {
+        throw std::runtime_error("Cannot extend a ChordProgression with itself.");
+    }
+    appendMoved(other.m_chords.data(), other.m_chords.size());
+    if (!other.m_chords.empty()) {
+        other.m_chords.clear();
+        other.recordEdit(ProgressionEdit::Reset, 0, 0);
+    }
+}
+
+void ChordProgression::extend(std::vector<Chord>&& chords) {
+    appendMoved(chords.data(), chords.size());
+    chords.clear();
+}
+
+void ChordProgression::appendMoved(Chord* first, std::size_t count) {
+    if (count == 0) return;
+    std::size_t index = m_chords.size();
+    m_chords.reserve(index + count);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_chords.push_back(std::move(first[i]));
+    }
+    recordEdit(ProgressionEdit::Insert, index, count);
+}
+
+void ChordProgression::insert(std::size_t index, Chord&& chord) {
+    if (index > m_chords.size()) {
+        throw std::runtime_error("Index out of range in ChordProgression::insert.");
+    }
+    m_chords.insert(m_chords.begin() + index, std::move(chord));
+    recordEdit(ProgressionEdit::Insert, index, 1);
 }
 
 void ChordProgression::insert(std::size_t index, const Chord& chord) {
@@ -40,6 +138,7 @@ void ChordProgression::insert(std::size_t index, const Chord& chord) {
         throw std::runtime_error("Index out of range in ChordProgression::insert.");
     }
     m_chords.insert(m_chords.begin() + index, chord);
+    recordEdit(ProgressionEdit::Insert, index, 1);
 }
 
 Chord ChordProgression::pop(std::size_t index) {
@@ -52,29 +151,117 @@ Chord ChordProgression::pop(std::size_t index) {
     if (index >= m_chords.size()) {
         throw std::runtime_error("Index out of range in ChordProgression::pop.");
     }
-    Chord removed = m_chords[index];
+    // Moves when we use the default resource; otherwise copies out so the
+    // returned chord does not point into our arena
+    Chord removed(std::move(m_chords[index]), allocator_type());
     m_chords.erase(m_chords.begin() + index);
+    recordEdit(ProgressionEdit::Erase, index, 1);
     return removed;
 }
 
+void ChordProgression::replace(std::size_t index, const Chord& chord) {
+    if (index >= m_chords.size()) {
+        throw std::runtime_error("Index out of range in ChordProgression::replace.");
+    }
+    m_chords[index] = chord;
+    recordEdit(ProgressionEdit::Replace, index, 1);
+}
+
+void ChordProgression::replace(std::size_t index, Chord&& chord) {
+    if (index >= m_chords.size()) {
+        throw std::runtime_error("Index out of range in ChordProgression::replace.");
+    }
+    m_chords[index] = std::move(chord);
+    recordEdit(ProgressionEdit::Replace, index, 1);
+}
+
 void ChordProgression::transpose(int semitones) {
     for (auto &c : m_chords) {
         c.transpose(semitones);
     }
+    if (semitones != 0 && !m_chords.empty()) {
+        recordEdit(ProgressionEdit::Replace, 0, m_chords.size());
+    }
+}
+
+std::uint64_t ChordProgression::revision() const {
+    return m_revision;
+}
+
+void ChordProgression::subscribeEdits() const {
+    m_logEdits = true;
+}
+
+bool ChordProgression::editsSince(std::uint64_t revision, std::vector<ProgressionEdit>& out) const {
+    out.clear();
+    if (revision == m_revision) {
+        return true;
+    }
+    std::size_t start = 0;
+    if (revision != m_baseRevision) {
+        auto it = m_edits.begin();
+        while (it != m_edits.end() && it->revision != revision) {
+            ++it;
+        }
+        if (it == m_edits.end()) {
+            return false;
+        }
+        start = static_cast<std::size_t>(it - m_edits.begin()) + 1;
+    }
+    out.assign(m_edits.begin() + start, m_edits.end());
+    return true;
 }
 
-std::vector<Chord>& ChordProgression::chords() {
+void ChordProgression::recordEdit(ProgressionEdit::Kind kind, std::size_t index, std::size_t count) {
+    m_revision = nextRevision();
+    if (!m_logEdits) {
+        m_baseRevision = m_revision;  // nobody asks for the history
+        return;
+    }
+    // Drop the older half at once, so trimming stays amortized O(1) on a flat vector
+    if (m_edits.size() == 2 * MAX_LOGGED_EDITS) {
+        m_baseRevision = m_edits[MAX_LOGGED_EDITS - 1].revision;
+        m_edits.erase(m_edits.begin(), m_edits.begin() + MAX_LOGGED_EDITS);
+    }
+    m_edits.push_back(ProgressionEdit{kind, index, count, m_revision});
+}
+
+std::pmr::vector<Chord>& ChordProgression::chords() {
+    recordEdit(ProgressionEdit::Reset, 0, m_chords.size());
     return m_chords;
 }
 
-const std::vector<Chord>& ChordProgression::chords() const {
+const std::pmr::vector<Chord>& ChordProgression::chords() const {
     return m_chords;
 }
 
+std::size_t ChordProgression::size() const {
+    return m_chords.size();
+}
+
+std::size_t ChordProgression::pitchCount() const {
+    std::size_t total = 0;
+    for (const auto& c : m_chords) {
+        total += c.componentCount();
+    }
+    return total;
+}
+
+std::size_t ChordProgression::pitches(int rootOctave, int* notes, std::size_t capacity, std::size_t* offsets) const {
+    std::size_t written = 0;
+    for (std::size_t i = 0; i < m_chords.size(); ++i) {
+        offsets[i] = written;
+        written += m_chords[i].pitches(rootOctave, notes + written, capacity - written);
+    }
+    offsets[m_chords.size()] = written;
+    return written;
+}
+
 Chord& ChordProgression::operator[](std::size_t index) {
     if (index >= m_chords.size()) {
         throw std::runtime_error("Index out of range in ChordProgression::operator[]");
     }
+    recordEdit(ProgressionEdit::Replace, index, 1);
     return m_chords[index];
 }
 
@@ -86,7 +273,19 @@ const Chord& ChordProgression::operator[](std::size_t index) const {
 }
 
 ChordProgression& ChordProgression::operator+=(const ChordProgression& other) {
+    std::size_t index = m_chords.size();
     m_chords.insert(m_chords.end(), other.m_chords.begin(), other.m_chords.end());
+    if (!other.m_chords.empty()) {
+        recordEdit(ProgressionEdit::Insert, index, other.m_chords.size());
+    }
+    return *this;
+}
+
+ChordProgression& ChordProgression::operator+=(ChordProgression&& other) {
+    if (&other == this) {
+        return *this += static_cast<const ChordProgression&>(other);
+    }
+    extend(std::move(other));
     return *this;
 }
 
@@ -105,7 +304,7 @@ bool ChordProgression::operator==(const ChordProgression& other) const {
 std::string ChordProgression::toString() const {
     std::ostringstream oss;
     for (size_t i = 0; i < m_chords.size(); ++i) {
-        oss << m_chords[i].chordName();
+        oss << m_chords[i].chordNameView();
         if (i + 1 < m_chords.size()) {
             oss << " | ";
         }
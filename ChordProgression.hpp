@@ -2,44 +2,124 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <memory_resource>
 #include "Chord.hpp"
 
+/**
+ * One structural change to a ChordProgression, recorded so that caches of
+ * derived data can recompute only what changed.
+ */
+struct ProgressionEdit {
+    enum Kind { Insert, Erase, Replace, Reset };
+    Kind kind;
+    std::size_t index;   // first affected chord
+    std::size_t count;   // number of chords inserted / erased / replaced
+    std::uint64_t revision; // revision of the progression after this edit
+};
+
 /**
  * Represents a progression of Chords.
+ *
+ * Allocator-aware: the chord vector and every Chord in it use the progression's
+ * memory resource, e.g. a std::pmr::monotonic_buffer_resource for a whole batch.
  */
 
 class ChordProgression {
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
     // Constructors
     ChordProgression(); // empty
-    explicit ChordProgression(const std::string& singleChord);
-    explicit ChordProgression(const Chord& singleChord);
-    explicit ChordProgression(const std::vector<std::string>& chordNames);
-    explicit ChordProgression(const std::vector<Chord>& chords);
+    explicit ChordProgression(const allocator_type& alloc);
+    explicit ChordProgression(const std::string& singleChord, const allocator_type& alloc = allocator_type());
+    explicit ChordProgression(const Chord& singleChord, const allocator_type& alloc = allocator_type());
+    explicit ChordProgression(const std::vector<std::string>& chordNames, const allocator_type& alloc = allocator_type());
+    explicit ChordProgression(const std::vector<Chord>& chords, const allocator_type& alloc = allocator_type());
+    explicit ChordProgression(std::vector<Chord>&& chords, const allocator_type& alloc = allocator_type());
+
+    // Copy / move, optionally into another memory resource
+    ChordProgression(const ChordProgression& other) = default;
+    ChordProgression(ChordProgression&& other) = default;
+    ChordProgression(const ChordProgression& other, const allocator_type& alloc);
+    ChordProgression& operator=(const ChordProgression& other) = default;
+    ChordProgression& operator=(ChordProgression&& other) = default;
+
+    allocator_type get_allocator() const;
 
     // Adding / removing
     void append(const Chord& chord);
+    void append(Chord&& chord);
     void insert(std::size_t index, const Chord& chord);
+    void insert(std::size_t index, Chord&& chord);
     Chord pop(std::size_t index = static_cast<std::size_t>(-1));
+    void replace(std::size_t index, const Chord& chord);
+    void replace(std::size_t index, Chord&& chord);
+
+    // Construct a chord from its symbol in place, in the progression's resource
+    Chord& emplace_back(const std::string& symbol);
+    Chord& emplace(std::size_t index, const std::string& symbol);
+
+    // Move every chord of 'other' to the end; 'other' is left empty
+    void extend(ChordProgression&& other);
+    void extend(std::vector<Chord>&& chords);
 
     // Transpose
     void transpose(int semitones);
 
-    // Access
-    std::vector<Chord>& chords();
-    const std::vector<Chord>& chords() const;
+    /**
+     * Change tracking. Every mutation gets a process-wide unique revision, so a
+     * cache that remembers revision() can later ask editsSince() what happened.
+     * The non-const operator[] and chords() hand out write access, so they
+     * count as a Replace of that chord and a Reset (anything may change);
+     * read through a const ChordProgression& to leave the revision alone.
+     * Edits are only logged once a cache has called subscribeEdits(); before
+     * that only the revision advances and the log allocates nothing.
+     */
+    std::uint64_t revision() const;
+    // Start logging edits from the current revision on (the log uses the progression's resource)
+    void subscribeEdits() const;
+    // Edits after 'revision', oldest first; false if that revision is not in the log
+    bool editsSince(std::uint64_t revision, std::vector<ProgressionEdit>& out) const;
+
+    // Access; a std::pmr::vector in the progression's resource (a std::vector<Chord> before pmr support)
+    std::pmr::vector<Chord>& chords();
+    const std::pmr::vector<Chord>& chords() const;
+
+    /**
+     * Playback data for the whole progression without heap allocations.
+     * pitchCount() is the total number of notes pitches() will write.
+     * pitches() writes every chord's MIDI notes back to back into 'notes' and, for
+     * chord i, stores its range as [offsets[i], offsets[i+1]). 'offsets' must hold
+     * size()+1 entries. Returns the total number of notes written.
+     */
+    std::size_t size() const;
+    std::size_t pitchCount() const;
+    std::size_t pitches(int rootOctave, int* notes, std::size_t capacity, std::size_t* offsets) const;
 
     // Operators
     Chord& operator[](std::size_t index);
     const Chord& operator[](std::size_t index) const;
 
     ChordProgression& operator+=(const ChordProgression& other);
+    ChordProgression& operator+=(ChordProgression&& other);
     bool operator==(const ChordProgression& other) const;
     bool operator!=(const ChordProgression& other) const { return !(*this == other); }
 
     // Info
     std::string toString() const;
 
+    // At least this many recent edits are kept for editsSince()
+    static constexpr std::size_t MAX_LOGGED_EDITS = 256;
+
 private:
-    std::vector<Chord> m_chords;
+    std::pmr::vector<Chord> m_chords;
+
+    std::uint64_t m_revision;      // current revision
+    std::uint64_t m_baseRevision;  // revision the edit log starts from
+    std::pmr::vector<ProgressionEdit> m_edits;  // oldest first, trimmed by halves
+    mutable bool m_logEdits = false;
+
+    void recordEdit(ProgressionEdit::Kind kind, std::size_t index, std::size_t count);
+    void appendMoved(Chord* first, std::size_t count);
 };
@@ -0,0 +1,211 @@
+#include "ChordSegmenter.hpp"
+#include "Parallel.hpp"
+#include "QualityManager.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+ChordSegmenter::ChordSegmenter(const SegmenterOptions& options)
+    : ChordSegmenter(options, QualityManager::Instance())
+{
+}
+
+ChordSegmenter::ChordSegmenter(const SegmenterOptions& options, const QualityManager& qualities)
+    : m_options(options), m_qualities(&qualities)
+{
+    if (!(options.frameDuration > 0.0)) {
+        throw std::runtime_error("SegmenterOptions::frameDuration must be positive.");
+    }
+    if (!(options.maxSpan >= options.frameDuration)) {
+        throw std::runtime_error("SegmenterOptions::maxSpan must be at least one frame.");
+    }
+    if (!(options.beatLength > 0.0) || !(options.barLength > 0.0)) {
+        throw std::runtime_error("SegmenterOptions::beatLength and barLength must be positive.");
+    }
+    m_maxFrames = static_cast<std::size_t>(std::floor(options.maxSpan / options.frameDuration + 1e-9));
+
+    // Linear templates: "N" scores nothing, chords reward their tones and charge for the rest
+    m_size = 1 + 12 * options.qualities.size();
+    m_weights.assign(m_size * 12, 0.0f);
+    m_frameBias.assign(m_size, 0.0f);
+    for (std::size_t q = 0; q < options.qualities.size(); ++q) {
+        if (!qualities.hasQuality(options.qualities[q])) {
+            throw std::runtime_error("Unknown quality in SegmenterOptions: " + options.qualities[q]);
+        }
+        auto quality = qualities.getQuality(options.qualities[q]);
+        unsigned mask = 0;
+        for (int interval : quality->getIntervals()) {
+            mask |= 1u << (((interval % 12) + 12) % 12);
+        }
+        const int tones = popcount12(mask);
+        const float bias = -options.complexityPenalty * std::max(0, tones - 3) *
+                           static_cast<float>(options.frameDuration);
+        for (int root = 0; root < 12; ++root) {
+            const std::size_t index = 1 + root * options.qualities.size() + q;
+            float* w = &m_weights[index * 12];
+            for (int interval = 0; interval < 12; ++interval) {
+                w[(root + interval) % 12] = (mask & (1u << interval)) ? options.chordToneWeight
+                                                                      : -options.nonChordTonePenalty;
+            }
+            w[root] += options.rootWeight;
+            m_frameBias[index] = bias;
+        }
+    }
+}
+
+// True when 'time' falls on a multiple of 'unit', up to rounding of the frame grid
+static bool onGrid(double time, double unit) {
+    const double r = std::fmod(time, unit);
+    const double eps = 1e-6 * unit;
+    return r < eps || unit - r < eps;
+}
+
+ChordSegmentation ChordSegmenter::segment(const std::vector<TimedNote>& notes) const {
+    return segment(notes.data(), notes.size());
+}
+
+ChordSegmentation ChordSegmenter::segment(const TimedNote* notes, std::size_t count) const {
+    ChordSegmentation result;
+    const double step = m_options.frameDuration;
+    double end = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const TimedNote& note = notes[i];
+        if (note.midi < 0 || note.midi > 127) {
+            throw std::runtime_error("TimedNote::midi out of range in ChordSegmenter::segment.");
+        }
+        if (!(note.onset >= 0.0) || !(note.offset > note.onset)) {
+            throw std::runtime_error("TimedNote needs 0 <= onset < offset in ChordSegmenter::segment.");
+        }
+        end = std::max(end, note.offset);
+    }
+    const std::size_t frames = static_cast<std::size_t>(std::ceil(end / step - 1e-9));
+    if (frames == 0) {
+        return result;
+    }
+
+    // Per-frame pitch-class histograms: sounding time of each pitch class inside the frame
+    std::vector<float> histogram(frames * 12, 0.0f);
+    for (std::size_t i = 0; i < count; ++i) {
+        const TimedNote& note = notes[i];
+        const int pc = note.midi % 12;
+        for (std::size_t f = static_cast<std::size_t>(note.onset / step); f < frames && f * step < note.offset; ++f) {
+            const double overlap = std::min(note.offset, (f + 1) * step) - std::max(note.onset, f * step);
+            if (overlap > 0.0) {
+                histogram[f * 12 + pc] += static_cast<float>(overlap);
+            }
+        }
+    }
+
+    // Prefix sums of the template scores: span [i, j) of chord c scores prefix[j][c] - prefix[i][c]
+    const std::size_t size = m_size;
+    std::vector<double> prefix((frames + 1) * size, 0.0);
+    for (std::size_t f = 0; f < frames; ++f) {
+        const float* h = &histogram[f * 12];
+        const double* from = &prefix[f * size];
+        double* to = &prefix[(f + 1) * size];
+        for (std::size_t c = 0; c < size; ++c) {
+            const float* w = &m_weights[c * 12];
+            float s = m_frameBias[c];
+            for (int pc = 0; pc < 12; ++pc) {
+                s += w[pc] * h[pc];
+            }
+            to[c] = from[c] + s;
+        }
+    }
+
+    // Cost of starting a chord at each frame boundary (harmonic rhythm)
+    std::vector<double> startCost(frames, 0.0);
+    for (std::size_t f = 1; f < frames; ++f) {
+        const double time = f * step;
+        double cost = m_options.changePenalty;
+        if (!onGrid(time, m_options.barLength)) {
+            cost += onGrid(time, m_options.beatLength) ? m_options.offBarPenalty : m_options.offBeatPenalty;
+        }
+        startCost[f] = cost;
+    }
+
+    // best[j]: best split of frames [0, j); the last span is [from[j], j) holding chord[j]
+    std::vector<double> best(frames + 1, -std::numeric_limits<double>::infinity());
+    std::vector<std::size_t> from(frames + 1, 0);
+    std::vector<std::size_t> chord(frames + 1, 0);
+    best[0] = 0.0;
+    for (std::size_t j = 1; j <= frames; ++j) {
+        const double* right = &prefix[j * size];
+        const std::size_t first = j > m_maxFrames ? j - m_maxFrames : 0;
+        for (std::size_t i = first; i < j; ++i) {
+            const double* left = &prefix[i * size];
+            std::size_t bestChord = 0;
+            double bestSpan = right[0] - left[0];
+            for (std::size_t c = 1; c < size; ++c) {
+                const double s = right[c] - left[c];
+                if (s > bestSpan) {
+                    bestSpan = s;
+                    bestChord = c;
+                }
+            }
+            const double total = best[i] - startCost[i] + bestSpan;
+            if (total > best[j]) {
+                best[j] = total;
+                from[j] = i;
+                chord[j] = bestChord;
+            }
+        }
+    }
+    result.score = best[frames];
+
+    // Walk the spans back, then emit them in order, merging repeats split by maxSpan
+    std::vector<std::size_t> ends;
+    for (std::size_t j = frames; j > 0; j = from[j]) {
+        ends.push_back(j);
+    }
+    std::reverse(ends.begin(), ends.end());
+    const std::size_t qualities = m_options.qualities.size();
+    std::size_t previous = 0;
+    for (std::size_t j : ends) {
+        const std::size_t state = chord[j];
+        const double startTime = from[j] * step;
+        const double endTime = std::min(j * step, end);
+        if (state != 0 && state == previous && !result.endTimes.empty() &&
+            result.endTimes.back() == startTime) {
+            result.endTimes.back() = endTime;
+            continue;
+        }
+        previous = state;
+        if (state == 0) {
+            continue;  // no chord
+        }
+        const int root = static_cast<int>((state - 1) / qualities);
+        const std::string& quality = m_options.qualities[(state - 1) % qualities];
+        result.progression.append(Chord::fromParts(valToNote(root), quality, "", *m_qualities));
+        result.startTimes.push_back(startTime);
+        result.endTimes.push_back(endTime);
+    }
+    return result;
+}
+
+std::size_t ChordSegmenter::vocabularySize() const {
+    return m_size;
+}
+
+std::string ChordSegmenter::vocabularySymbol(std::size_t index) const {
+    if (index >= m_size) {
+        throw std::runtime_error("Index out of range in ChordSegmenter::vocabularySymbol.");
+    }
+    if (index == 0) {
+        return "N";
+    }
+    const std::size_t qualities = m_options.qualities.size();
+    return valToNote(static_cast<int>((index - 1) / qualities)) + m_options.qualities[(index - 1) % qualities];
+}
+
+std::vector<ChordSegmentation> segmentChordsBatch(const ChordSegmenter& segmenter,
+                                                  const std::vector<std::vector<TimedNote>>& pieces,
+                                                  unsigned threads) {
+    std::vector<ChordSegmentation> results(pieces.size());
+    parallelFor(pieces.size(), threads, [&](std::size_t i) {
+        results[i] = segmenter.segment(pieces[i]);
+    });
+    return results;
+}
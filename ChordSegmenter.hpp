@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ChordProgression.hpp"
+
+class QualityManager;
+
+/**
+ * Chord segmentation of a timed note stream (e.g. a MIDI performance): the
+ * timeline is cut into a grid of frames, every candidate span of up to
+ * maxSpan is scored against the quality templates of a QualityManager, and a
+ * dynamic program picks the best split. Span scores come from per-frame
+ * pitch-class histograms through prefix sums, so the whole search is
+ * O(frames x span frames x vocabulary).
+ *
+ * Times are in any unit (seconds or beats) as long as the notes and the
+ * options agree.
+ */
+
+struct TimedNote {
+    int midi;                         // 0..127
+    double onset;
+    double offset;                    // > onset
+};
+
+struct SegmenterOptions {
+    double frameDuration = 0.25;      // grid step
+    double maxSpan = 8.0;             // longest single chord span
+    // Qualities making up the vocabulary, on every one of the 12 roots; "N" (no chord) is always added
+    std::vector<std::string> qualities = {"", "m", "7", "maj7", "m7", "dim", "m7b5", "aug", "sus4"};
+    float chordToneWeight = 1.0f;     // per unit of sounding time of a chord tone
+    float rootWeight = 0.5f;          // extra weight for time spent on the root
+    float nonChordTonePenalty = 1.2f; // per unit of sounding time outside the chord (passing tones)
+    float complexityPenalty = 0.1f;   // per unit of span time and per chord tone beyond three
+    // Harmonic rhythm: every new chord pays changePenalty, plus a surcharge when it
+    // does not start on a bar line (offBarPenalty) or not even on a beat (offBeatPenalty)
+    float changePenalty = 1.0f;
+    double beatLength = 1.0;
+    double barLength = 4.0;
+    float offBarPenalty = 0.25f;
+    float offBeatPenalty = 1.0f;
+};
+
+struct ChordSegmentation {
+    ChordProgression progression;     // chosen chords, "N" spans left out
+    std::vector<double> startTimes;   // one per chord in progression
+    std::vector<double> endTimes;
+    double score = 0.0;               // total score of the chosen split
+};
+
+class ChordSegmenter {
+public:
+    // Templates from QualityManager::Instance()
+    explicit ChordSegmenter(const SegmenterOptions& options = SegmenterOptions());
+    // Templates from 'qualities', which must outlive the segmenter
+    ChordSegmenter(const SegmenterOptions& options, const QualityManager& qualities);
+
+    // Best split of one piece; notes may come in any order and overlap freely
+    ChordSegmentation segment(const std::vector<TimedNote>& notes) const;
+    ChordSegmentation segment(const TimedNote* notes, std::size_t count) const;
+
+    // Vocabulary: 0 is "N", entry i > 0 is root (i - 1) / qualities with quality (i - 1) % qualities
+    std::size_t vocabularySize() const;
+    std::string vocabularySymbol(std::size_t index) const;
+
+private:
+    SegmenterOptions m_options;
+    const QualityManager* m_qualities;
+    std::size_t m_size;
+    std::size_t m_maxFrames;          // maxSpan in frames
+    std::vector<float> m_weights;     // size x 12, score per unit of time on each pitch class
+    std::vector<float> m_frameBias;   // size, score per frame regardless of the notes
+};
+
+// Many pieces at once, spread over 'threads' workers (0 = hardware concurrency)
+std::vector<ChordSegmentation> segmentChordsBatch(const ChordSegmenter& segmenter,
+                                                  const std::vector<std::vector<TimedNote>>& pieces,
+                                                  unsigned threads = 0);
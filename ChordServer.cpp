@@ -0,0 +1,367 @@
+#include "ChordServer.hpp"
+#include "BoundedQueue.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const std::uint64_t LISTEN_KEY = 0;
+static const std::uint64_t WAKE_KEY = 1;
+
+static std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+static sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+ChordServer::ChordServer(const std::string& socketPath, const ServerOptions& options)
+    : m_path(socketPath), m_options(options)
+{
+    const sockaddr_un address = unixAddress(socketPath);
+
+    // A socket file nobody listens on is left over from a previous run; anything else is not ours
+    struct stat existing;
+    if (::lstat(socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            throw std::runtime_error("Cannot listen on " + socketPath + ": path exists and is not a socket");
+        }
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe >= 0) {
+            const bool live = ::connect(probe, reinterpret_cast<const sockaddr*>(&address),
+                                        sizeof(address)) == 0;
+            ::close(probe);
+            if (live) {
+                throw std::runtime_error("Socket already in use: " + socketPath);
+            }
+        }
+        ::unlink(socketPath.c_str());
+    }
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_listenFd < 0) {
+        throw systemError("socket");
+    }
+    if (::bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(m_listenFd, m_options.backlog) != 0) {
+        const std::runtime_error error = systemError("Cannot listen on " + socketPath);
+        ::close(m_listenFd);
+        throw error;
+    }
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        const std::runtime_error error = systemError("eventfd");
+        ::close(m_listenFd);
+        ::unlink(socketPath.c_str());
+        throw error;
+    }
+}
+
+ChordServer::~ChordServer() {
+    ::close(m_wakeFd);
+    ::close(m_listenFd);
+    ::unlink(m_path.c_str());
+}
+
+void ChordServer::stop() {
+    m_stopping.store(true);
+    const std::uint64_t one = 1;
+    // write() is async-signal-safe; a full counter already means "wake up"
+    ssize_t ignored = ::write(m_wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+const std::string& ChordServer::socketPath() const {
+    return m_path;
+}
+
+struct ServerConnection {
+    int fd = -1;
+    std::string in;
+    std::string out;
+    std::size_t outOffset = 0;
+    std::size_t inFlight = 0;     // requests handed to workers, not yet in 'out'
+    bool readClosed = false;      // peer shut down its writing side
+    std::uint32_t events = 0;     // current epoll interest
+};
+
+struct ServerBatch {
+    std::vector<std::uint64_t> owners;   // connection key per request
+    std::vector<ChordRequest> requests;
+};
+
+// Encoded responses for one connection
+struct ServerReply {
+    std::uint64_t owner;
+    std::size_t count;            // responses in 'frames'
+    std::string frames;
+};
+
+ServerStats ChordServer::run() {
+    ServerStats stats;
+    const int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        throw systemError("epoll_create1");
+    }
+    auto watch = [&](int op, int fd, std::uint32_t events, std::uint64_t key) {
+        epoll_event event;
+        event.events = events;
+        event.data.u64 = key;
+        if (::epoll_ctl(epollFd, op, fd, &event) != 0) {
+            throw systemError("epoll_ctl");
+        }
+    };
+    watch(EPOLL_CTL_ADD, m_listenFd, EPOLLIN, LISTEN_KEY);
+    watch(EPOLL_CTL_ADD, m_wakeFd, EPOLLIN, WAKE_KEY);
+
+    // Workers: answer a batch, group the frames by connection, wake the loop
+    std::mutex replyMutex;
+    std::vector<ServerReply> replies;
+    BoundedQueue<ServerBatch> work(m_options.queueDepth);
+    unsigned workerCount = m_options.workers ? m_options.workers : std::thread::hardware_concurrency();
+    if (workerCount == 0) workerCount = 1;
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < workerCount; ++w) {
+        workers.emplace_back([&] {
+            ServerBatch batch;
+            std::vector<ChordResponse> responses;
+            while (work.pop(batch)) {
+                responses.resize(batch.requests.size());
+                m_service.handleBatch(batch.requests.data(), batch.requests.size(), responses.data());
+                std::vector<ServerReply> done;
+                for (std::size_t i = 0; i < responses.size(); ++i) {
+                    if (done.empty() || done.back().owner != batch.owners[i]) {
+                        done.push_back(ServerReply{batch.owners[i], 0, std::string()});
+                    }
+                    appendChordResponse(done.back().frames, responses[i]);
+                    ++done.back().count;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(replyMutex);
+                    for (auto& reply : done) replies.push_back(std::move(reply));
+                }
+                const std::uint64_t one = 1;
+                ssize_t ignored = ::write(m_wakeFd, &one, sizeof(one));
+                (void)ignored;
+            }
+        });
+    }
+
+    std::unordered_map<std::uint64_t, ServerConnection> connections;
+    std::uint64_t nextKey = WAKE_KEY + 1;
+    ServerBatch batch;
+
+    auto dispatch = [&] {
+        if (batch.requests.empty()) return;
+        ++stats.batches;
+        work.push(std::move(batch));
+        batch = ServerBatch();
+        batch.owners.reserve(m_options.maxBatch);
+        batch.requests.reserve(m_options.maxBatch);
+    };
+    auto closeConnection = [&](std::uint64_t key) {
+        auto it = connections.find(key);
+        if (it == connections.end()) return;
+        ::close(it->second.fd);   // also removes it from the epoll set
+        connections.erase(it);
+    };
+    // Writes what the socket takes; false if the connection failed
+    auto flush = [&](ServerConnection& connection) {
+        while (connection.outOffset < connection.out.size()) {
+            const ssize_t n = ::send(connection.fd, connection.out.data() + connection.outOffset,
+                                     connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+            if (n > 0) {
+                connection.outOffset += static_cast<std::size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            } else {
+                return false;
+            }
+        }
+        connection.out.clear();
+        connection.outOffset = 0;
+        return true;
+    };
+    // Backpressure: a connection with too much unanswered or unsent work is not read from
+    auto saturated = [&](const ServerConnection& connection) {
+        return connection.inFlight >= m_options.maxInFlight ||
+               connection.out.size() - connection.outOffset >= m_options.maxPendingBytes;
+    };
+    // Re-arms epoll for what the connection can do now, or closes it once a
+    // half-closed peer has all its answers; false if it was closed
+    auto update = [&](std::uint64_t key, ServerConnection& connection) {
+        const bool pendingOut = connection.outOffset < connection.out.size();
+        if (connection.readClosed && connection.inFlight == 0 && !pendingOut) {
+            closeConnection(key);
+            return false;
+        }
+        std::uint32_t events = 0;
+        if (!connection.readClosed && !saturated(connection)) events |= EPOLLIN | EPOLLRDHUP;
+        if (pendingOut) events |= EPOLLOUT;
+        if (events != connection.events) {
+            watch(EPOLL_CTL_MOD, connection.fd, events, key);
+            connection.events = events;
+        }
+        return true;
+    };
+    // Reads and queues complete frames until the socket is drained, the peer
+    // shuts down its side or the connection is saturated; false on error
+    auto receive = [&](std::uint64_t key, ServerConnection& connection) {
+        char buffer[65536];
+        while (!saturated(connection)) {
+            const ssize_t n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0) return false;
+            if (n == 0) {
+                connection.readClosed = true;   // answer what we have, then close
+                break;
+            }
+            connection.in.append(buffer, static_cast<std::size_t>(n));
+            std::size_t offset = 0;
+            ChordRequest request;
+            try {
+                while (takeChordRequest(connection.in, offset, request)) {
+                    batch.owners.push_back(key);
+                    batch.requests.push_back(std::move(request));
+                    ++connection.inFlight;
+                    ++stats.requests;
+                    if (batch.requests.size() >= m_options.maxBatch) dispatch();
+                }
+            } catch (const std::runtime_error&) {
+                return false;   // oversized frame: the stream cannot be resynchronised
+            }
+            connection.in.erase(0, offset);
+        }
+        return true;
+    };
+
+    epoll_event events[64];
+    try {
+        while (!m_stopping.load()) {
+            const int ready = ::epoll_wait(epollFd, events, 64, -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                throw systemError("epoll_wait");
+            }
+            for (int e = 0; e < ready; ++e) {
+                const std::uint64_t key = events[e].data.u64;
+                if (key == LISTEN_KEY) {
+                    for (;;) {
+                        const int fd = ::accept4(m_listenFd, nullptr, nullptr,
+                                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+                        if (fd < 0) break;
+                        const std::uint64_t connectionKey = nextKey++;
+                        ServerConnection& connection = connections[connectionKey];
+                        connection.fd = fd;
+                        connection.events = EPOLLIN | EPOLLRDHUP;
+                        watch(EPOLL_CTL_ADD, fd, connection.events, connectionKey);
+                        ++stats.connections;
+                    }
+                } else if (key == WAKE_KEY) {
+                    std::uint64_t count;
+                    ssize_t ignored = ::read(m_wakeFd, &count, sizeof(count));
+                    (void)ignored;
+                    std::vector<ServerReply> pending;
+                    {
+                        std::lock_guard<std::mutex> lock(replyMutex);
+                        pending.swap(replies);
+                    }
+                    for (auto& reply : pending) {
+                        auto it = connections.find(reply.owner);
+                        if (it == connections.end()) continue;   // client went away
+                        ServerConnection& connection = it->second;
+                        connection.inFlight -= reply.count;
+                        connection.out += reply.frames;
+                        if (flush(connection)) {
+                            update(reply.owner, connection);
+                        } else {
+                            closeConnection(reply.owner);
+                        }
+                    }
+                } else {
+                    auto it = connections.find(key);
+                    if (it == connections.end()) continue;
+                    ServerConnection& connection = it->second;
+                    const std::uint32_t mask = events[e].events;
+                    bool alive = true;
+                    if (mask & EPOLLOUT) {
+                        alive = flush(connection);
+                    }
+                    if (alive && !connection.readClosed &&
+                        (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                        alive = receive(key, connection);
+                    } else if (mask & (EPOLLHUP | EPOLLERR)) {
+                        alive = false;   // both directions gone: nobody will read the answers
+                    }
+                    if (alive) {
+                        update(key, connection);
+                    } else {
+                        closeConnection(key);
+                    }
+                }
+            }
+            // Everything that arrived in this pass goes out as one batch
+            dispatch();
+        }
+    } catch (...) {
+        work.close();
+        for (auto& worker : workers) worker.join();
+        for (auto& entry : connections) ::close(entry.second.fd);
+        ::close(epollFd);
+        throw;
+    }
+
+    work.close();
+    for (auto& worker : workers) worker.join();
+    for (auto& entry : connections) ::close(entry.second.fd);
+    ::close(epollFd);
+    return stats;
+}
+
+#else
+
+ChordServer::ChordServer(const std::string& socketPath, const ServerOptions& options)
+    : m_path(socketPath), m_options(options)
+{
+    throw std::runtime_error("ChordServer requires Linux (epoll)");
+}
+
+ChordServer::~ChordServer() = default;
+
+ServerStats ChordServer::run() {
+    throw std::runtime_error("ChordServer requires Linux (epoll)");
+}
+
+void ChordServer::stop() {
+    m_stopping.store(true);
+}
+
+const std::string& ChordServer::socketPath() const {
+    return m_path;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include "ChordService.hpp"
+
+/**
+ * Chord-analysis daemon on a Unix domain socket (Linux, epoll).
+ *
+ * One event-loop thread accepts connections and decodes request frames
+ * (see ChordService.hpp). Every request that arrives during one pass over
+ * the ready sockets goes into the same batch, up to maxBatch, so many small
+ * concurrent requests cost one hand-off to the worker pool instead of one
+ * each. Workers answer a batch with ChordService and hand the encoded
+ * responses back to the loop, which writes them without blocking. Responses
+ * on one connection may come back out of order; clients match them by id.
+ *
+ * A client that stops reading is not read from either once it reaches
+ * maxInFlight or maxPendingBytes, so its buffers stay bounded. A client that
+ * shuts down its writing side still gets every answer before the server
+ * closes the connection.
+ */
+
+struct ServerOptions {
+    unsigned workers = 0;          // 0: hardware concurrency
+    std::size_t maxBatch = 256;    // requests per batch
+    std::size_t queueDepth = 64;   // batches waiting for a worker
+    int backlog = 128;             // listen() backlog
+    // Per connection: stop reading requests while this many are unanswered,
+    // or while this many response bytes wait for the client to read them
+    std::size_t maxInFlight = 4096;
+    std::size_t maxPendingBytes = std::size_t(1) << 20;
+};
+
+struct ServerStats {
+    std::size_t connections = 0;
+    std::size_t requests = 0;
+    std::size_t batches = 0;
+};
+
+class ChordServer {
+public:
+    // Binds and listens on 'socketPath', replacing a stale socket file; any
+    // other file already at that path is an error and is left alone
+    explicit ChordServer(const std::string& socketPath,
+                         const ServerOptions& options = ServerOptions());
+    ~ChordServer();
+
+    ChordServer(const ChordServer&) = delete;
+    ChordServer& operator=(const ChordServer&) = delete;
+
+    // Serves until stop(); returns totals
+    ServerStats run();
+    // Safe from any thread and from a signal handler
+    void stop();
+
+    const std::string& socketPath() const;
+
+private:
+    std::string m_path;
+    ServerOptions m_options;
+    ChordService m_service;
+    int m_listenFd = -1;
+    int m_wakeFd = -1;   // eventfd: completions ready or stop requested
+    std::atomic<bool> m_stopping{false};
+};
@@ -0,0 +1,144 @@
+#include "ChordService.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+static void putU16(std::string& out, std::uint16_t v) {
+    out += static_cast<char>(v & 0xFF);
+    out += static_cast<char>(v >> 8);
+}
+
+static void putU32(std::string& out, std::uint32_t v) {
+    putU16(out, static_cast<std::uint16_t>(v & 0xFFFF));
+    putU16(out, static_cast<std::uint16_t>(v >> 16));
+}
+
+static std::uint16_t getU16(const std::string& in, std::size_t at) {
+    return static_cast<std::uint16_t>(static_cast<unsigned char>(in[at]) |
+                                      (static_cast<unsigned char>(in[at + 1]) << 8));
+}
+
+static std::uint32_t getU32(const std::string& in, std::size_t at) {
+    return getU16(in, at) | (static_cast<std::uint32_t>(getU16(in, at + 2)) << 16);
+}
+
+// Length of the frame at 'offset' if complete, 0 otherwise
+static std::size_t frameLength(const std::string& in, std::size_t offset, std::size_t header) {
+    if (in.size() - offset < header) return 0;
+    const std::uint32_t payload = getU32(in, offset);
+    if (payload > CHORD_MAX_PAYLOAD) {
+        throw std::runtime_error("Chord frame too large: " + std::to_string(payload) + " bytes");
+    }
+    if (in.size() - offset < header + payload) return 0;
+    return header + payload;
+}
+
+static ChordResponse describe(std::uint32_t id, const Chord& chord) {
+    ChordResponse response;
+    response.id = id;
+    response.name = chord.chordName();
+    response.root = static_cast<std::uint8_t>(noteToVal(chord.rootView()));
+    response.bass = chord.onView().empty()
+        ? response.root
+        : static_cast<std::uint8_t>(noteToVal(chord.onView()));
+    response.mask = static_cast<std::uint16_t>(chord.pitchClassMask());
+    return response;
+}
+
+void appendChordRequest(std::string& out, const ChordRequest& request) {
+    if (request.payload.size() > CHORD_MAX_PAYLOAD) {
+        throw std::runtime_error("Chord request payload too large");
+    }
+    putU32(out, static_cast<std::uint32_t>(request.payload.size()));
+    putU32(out, request.id);
+    out += static_cast<char>(request.op);
+    out += '\0';
+    putU16(out, static_cast<std::uint16_t>(request.arg));
+    out += request.payload;
+}
+
+void appendChordResponse(std::string& out, const ChordResponse& response) {
+    const std::size_t length = std::min(response.name.size(), CHORD_MAX_PAYLOAD);
+    putU32(out, static_cast<std::uint32_t>(length));
+    putU32(out, response.id);
+    out += static_cast<char>(response.status);
+    out += static_cast<char>(response.root);
+    out += static_cast<char>(response.bass);
+    out += '\0';
+    putU16(out, response.mask);
+    putU16(out, 0);
+    out.append(response.name, 0, length);
+}
+
+bool takeChordRequest(const std::string& in, std::size_t& offset, ChordRequest& request) {
+    const std::size_t length = frameLength(in, offset, CHORD_REQUEST_HEADER);
+    if (length == 0) return false;
+    request.id = getU32(in, offset + 4);
+    request.op = static_cast<ChordOp>(static_cast<unsigned char>(in[offset + 8]));
+    request.arg = static_cast<std::int16_t>(getU16(in, offset + 10));
+    request.payload.assign(in, offset + CHORD_REQUEST_HEADER, length - CHORD_REQUEST_HEADER);
+    offset += length;
+    return true;
+}
+
+bool takeChordResponse(const std::string& in, std::size_t& offset, ChordResponse& response) {
+    const std::size_t length = frameLength(in, offset, CHORD_RESPONSE_HEADER);
+    if (length == 0) return false;
+    response.id = getU32(in, offset + 4);
+    response.status = static_cast<ChordStatus>(static_cast<unsigned char>(in[offset + 8]));
+    response.root = static_cast<std::uint8_t>(in[offset + 9]);
+    response.bass = static_cast<std::uint8_t>(in[offset + 10]);
+    response.mask = getU16(in, offset + 12);
+    response.name.assign(in, offset + CHORD_RESPONSE_HEADER, length - CHORD_RESPONSE_HEADER);
+    offset += length;
+    return true;
+}
+
+ChordService::ChordService() = default;
+
+ChordResponse ChordService::handle(const ChordRequest& request) const {
+    ChordResponse response;
+    response.id = request.id;
+    try {
+        switch (request.op) {
+        case ChordOp::Parse:
+            return describe(request.id, Chord(request.payload));
+        case ChordOp::Transpose: {
+            Chord chord(request.payload);
+            chord.transpose(request.arg);
+            return describe(request.id, chord);
+        }
+        case ChordOp::Recognize: {
+            if (request.payload.empty()) {
+                throw std::runtime_error("No notes to recognize");
+            }
+            unsigned mask = 0;
+            int lowest = 128;
+            for (char c : request.payload) {
+                const int note = static_cast<unsigned char>(c);
+                if (note > 127) throw std::runtime_error("MIDI note out of range");
+                mask |= 1u << (note % 12);
+                if (note < lowest) lowest = note;
+            }
+            ChordMatch best;
+            if (m_matcher.match(mask, lowest % 12, &best, 1) == 0) {
+                throw std::runtime_error("No matching chord");
+            }
+            return describe(request.id, m_matcher.toChord(best));
+        }
+        }
+        response.status = ChordStatus::UnknownOp;
+        response.name = "Unknown op " + std::to_string(static_cast<int>(request.op));
+    } catch (const std::exception& e) {
+        response.status = ChordStatus::BadRequest;
+        response.name = e.what();
+    }
+    return response;
+}
+
+void ChordService::handleBatch(const ChordRequest* requests, std::size_t count,
+                               ChordResponse* responses) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        responses[i] = handle(requests[i]);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ChordMatcher.hpp"
+
+/**
+ * Request/response types and wire format shared by ChordServer, ChordClient
+ * and in-process callers, plus the engine that answers requests.
+ *
+ * Frames are little-endian:
+ *   request:  u32 payload length | u32 id | u8 op | u8 0 | i16 arg | payload
+ *   response: u32 payload length | u32 id | u8 status | u8 root | u8 bass | u8 0
+ *             | u16 pitch-class mask | u16 0 | payload (chord name)
+ * The payload is a chord symbol for Parse/Transpose and one byte per MIDI
+ * note for Recognize; 'arg' is the transposition in semitones.
+ */
+
+enum class ChordOp : std::uint8_t {
+    Parse = 1,
+    Recognize = 2,
+    Transpose = 3
+};
+
+enum class ChordStatus : std::uint8_t {
+    Ok = 0,
+    BadRequest = 1,   // unparsable symbol, no matching chord, ...
+    UnknownOp = 2
+};
+
+struct ChordRequest {
+    std::uint32_t id = 0;
+    ChordOp op = ChordOp::Parse;
+    std::int16_t arg = 0;
+    std::string payload;
+};
+
+struct ChordResponse {
+    std::uint32_t id = 0;
+    ChordStatus status = ChordStatus::Ok;
+    std::uint8_t root = 0;     // pitch class
+    std::uint8_t bass = 0;     // pitch class of the slash note, else the root
+    std::uint16_t mask = 0;    // pitch classes of the chord
+    std::string name;          // chord name, or an error message
+};
+
+static const std::size_t CHORD_REQUEST_HEADER = 12;
+static const std::size_t CHORD_RESPONSE_HEADER = 16;
+static const std::size_t CHORD_MAX_PAYLOAD = 4096;
+
+void appendChordRequest(std::string& out, const ChordRequest& request);
+void appendChordResponse(std::string& out, const ChordResponse& response);
+
+/**
+ * Decode one frame starting at 'offset' in 'in'. Returns false if the frame
+ * is not complete yet; on success advances 'offset'. Throws
+ * std::runtime_error if the frame is larger than CHORD_MAX_PAYLOAD.
+ */
+bool takeChordRequest(const std::string& in, std::size_t& offset, ChordRequest& request);
+bool takeChordResponse(const std::string& in, std::size_t& offset, ChordResponse& response);
+
+class ChordService {
+public:
+    ChordService();
+
+    // Thread-safe; never throws for bad input (status BadRequest instead)
+    ChordResponse handle(const ChordRequest& request) const;
+    void handleBatch(const ChordRequest* requests, std::size_t count, ChordResponse* responses) const;
+
+private:
+    ChordMatcher m_matcher;
+};
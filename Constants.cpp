@@ -6,7 +6,11 @@ const std::unordered_map<std::string, int> NOTE_VAL_DICT = {
     {"C", 0},  {"C#", 1}, {"Db", 1},
     {"D", 2},  {"D#", 3}, {"Eb", 3},
     {"E", 4},  {"F", 5},  {"F#", 6},
-    {"Gb", 6}, {"G", 7},  {"G#", 8}
+    {"Gb", 6}, {"G", 7},  {"G#", 8},
+    // Spellings that only appear in some keys
+    {"B#", 0}, {"E#", 5}, {"Fb", 4},
+    {"Cbb", 10}, {"Dbb", 0}, {"Ebb", 2}, {"Fbb", 3}, {"Gbb", 5}, {"Abb", 7}, {"Bbb", 9},
+    {"C##", 2}, {"D##", 4}, {"E##", 6}, {"F##", 7}, {"G##", 9}, {"A##", 11}, {"B##", 1}
 };
 
 const std::map<int, std::vector<std::string>> VAL_NOTE_DICT = {
@@ -55,6 +59,10 @@ const std::unordered_map<std::string, std::vector<int>> RELATIVE_KEY_DICT = {
     {"Loc", {0, 1, 3, 5, 6, 8, 10, 12}}
 };
 
+const std::vector<std::string> MODE_NAMES = {
+    "maj", "Dor", "Phr", "Lyd", "Mix", "min", "Loc"
+};
+
 const std::vector<std::pair<std::string, std::vector<int>>> DEFAULT_QUALITIES = {
     // 2-note
     {"5", {0, 7}},
@@ -35,6 +35,12 @@ extern const std::unordered_map<std::string, std::unordered_map<int, std::string
  */
 extern const std::unordered_map<std::string, std::vector<int>> RELATIVE_KEY_DICT;
 
+/**
+ * The keys of RELATIVE_KEY_DICT in modal order (Ionian .. Locrian).
+ * Used as the mode index of the precomputed diatonic tables.
+ */
+extern const std::vector<std::string> MODE_NAMES;
+
 /**
  * Default chord qualities:
  * e.g. { "m7", {0,3,7,10} }, etc.
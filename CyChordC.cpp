@@ -0,0 +1,171 @@
+#include "CyChordC.h"
+#include "Chord.hpp"
+#include "Constants.hpp"
+#include "FindChords.hpp"
+#include "Utils.hpp"
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Record-side view of the default vocabulary: DEFAULT_QUALITIES order is the ABI index
+struct QualityIndex {
+    std::vector<std::string> names;
+    std::unordered_map<std::string_view, std::int16_t> byName;
+
+    QualityIndex() {
+        names.reserve(DEFAULT_QUALITIES.size());
+        for (const auto& entry : DEFAULT_QUALITIES) {
+            names.push_back(entry.first);
+        }
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            byName.emplace(names[i], static_cast<std::int16_t>(i));
+        }
+    }
+};
+
+static const QualityIndex& qualityIndex() {
+    static const QualityIndex index;
+    return index;
+}
+
+static cychord_chord toRecord(const Chord& chord) {
+    const QualityIndex& index = qualityIndex();
+    cychord_chord record;
+    record.mask = static_cast<std::uint16_t>(chord.pitchClassMask());
+    record.root = static_cast<std::uint8_t>(noteToVal(chord.rootView()));
+    record.bass = record.root;
+    record.flags = 0;
+    if (!chord.onView().empty()) {
+        record.bass = static_cast<std::uint8_t>(noteToVal(chord.onView()));
+        record.flags |= CYCHORD_FLAG_SLASH;
+    }
+    if (!chord.appendedView().empty()) {
+        record.flags |= CYCHORD_FLAG_APPENDED;
+    }
+    auto it = index.byName.find(chord.quality()->getQualityName());
+    record.quality = it == index.byName.end() ? -1 : it->second;
+    return record;
+}
+
+static unsigned rotate12(unsigned mask, int by) {
+    mask &= 0xFFFu;
+    return ((mask << by) | (mask >> (12 - by))) & 0xFFFu;
+}
+
+extern "C" {
+
+uint32_t cychord_abi_version(void) {
+    return CYCHORD_ABI_VERSION;
+}
+
+size_t cychord_quality_count(void) {
+    return qualityIndex().names.size();
+}
+
+const char* cychord_quality_name(size_t index) {
+    const QualityIndex& qualities = qualityIndex();
+    return index < qualities.names.size() ? qualities.names[index].c_str() : nullptr;
+}
+
+size_t cychord_parse(const char* bytes, const uint32_t* offsets, size_t count,
+                     cychord_chord* out, int32_t* status) {
+    // Each chord lives in the stack arena and is dropped before the next one
+    alignas(std::max_align_t) char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+    std::string symbol;
+    size_t parsed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        std::memset(&out[i], 0, sizeof(out[i]));
+        out[i].quality = -1;
+        status[i] = CYCHORD_INVALID;
+        if (offsets[i + 1] < offsets[i]) continue;
+        try {
+            symbol.assign(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+            {
+                Chord chord(symbol, Chord::allocator_type(&arena));
+                out[i] = toRecord(chord);
+            }
+            status[i] = CYCHORD_OK;
+            ++parsed;
+        } catch (...) {
+        }
+        arena.release();
+    }
+    return parsed;
+}
+
+size_t cychord_find_chords(const uint8_t* notes, const uint32_t* offsets, size_t count,
+                           size_t per_input, cychord_chord* out, uint32_t* found,
+                           int32_t* status) {
+    std::vector<int> midi;
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        found[i] = 0;
+        status[i] = CYCHORD_INVALID;
+        if (offsets[i + 1] < offsets[i]) continue;
+        try {
+            midi.assign(notes + offsets[i], notes + offsets[i + 1]);
+            cychord_chord* slot = out + i * per_input;
+            for (const Chord& chord : ChordInterpretations(midi)) {
+                if (found[i] == per_input) break;
+                slot[found[i]++] = toRecord(chord);
+            }
+            status[i] = found[i] ? CYCHORD_OK : CYCHORD_NO_CHORD;
+            total += found[i];
+        } catch (...) {
+        }
+    }
+    return total;
+}
+
+void cychord_transpose(cychord_chord* chords, size_t count, int semitones) {
+    const int by = ((semitones % 12) + 12) % 12;
+    if (by == 0) return;
+    for (size_t i = 0; i < count; ++i) {
+        chords[i].mask = static_cast<std::uint16_t>(rotate12(chords[i].mask, by));
+        chords[i].root = static_cast<std::uint8_t>((chords[i].root + by) % 12);
+        chords[i].bass = static_cast<std::uint8_t>((chords[i].bass + by) % 12);
+    }
+}
+
+size_t cychord_render(const cychord_chord* chords, size_t count, const char* scale,
+                      char* bytes, size_t capacity, uint32_t* offsets, int32_t* status) {
+    const QualityIndex& qualities = qualityIndex();
+    const std::string_view key = scale ? scale : "C";
+    std::string name;
+    size_t used = 0;
+    bool full = false;
+    offsets[0] = 0;
+    for (size_t i = 0; i < count; ++i) {
+        status[i] = CYCHORD_INVALID;
+        const cychord_chord& chord = chords[i];
+        if (full) {
+            status[i] = CYCHORD_TRUNCATED;
+        } else if (chord.quality >= 0 && static_cast<size_t>(chord.quality) < qualities.names.size() &&
+                   chord.root < 12 && chord.bass < 12) {
+            try {
+                name = valToNote(chord.root, key);
+                name += qualities.names[static_cast<size_t>(chord.quality)];
+                if (chord.flags & CYCHORD_FLAG_SLASH) {
+                    name += displayOn(valToNote(chord.bass, key));
+                }
+                if (name.size() > capacity - used) {
+                    full = true;
+                    status[i] = CYCHORD_TRUNCATED;
+                } else {
+                    std::memcpy(bytes + used, name.data(), name.size());
+                    used += name.size();
+                    status[i] = CYCHORD_OK;
+                }
+            } catch (...) {
+            }
+        }
+        offsets[i + 1] = static_cast<uint32_t>(used);
+    }
+    return used;
+}
+
+} // extern "C"
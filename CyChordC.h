@@ -0,0 +1,88 @@
+#ifndef CYCHORD_C_H
+#define CYCHORD_C_H
+
+/**
+ * Stable C ABI for foreign-language callers (ctypes/cffi, cgo, ...).
+ *
+ * Every call handles a whole batch in flat buffers owned by the caller, so
+ * one call can process thousands of chords with no per-chord marshaling:
+ *
+ *   - text in:  'bytes' holds the items back to back, item i is
+ *               bytes[offsets[i] .. offsets[i + 1]), so 'offsets' has
+ *               count + 1 entries; no terminators are needed
+ *   - chords:   packed 8-byte cychord_chord records
+ *   - status:   one int32 per item (CYCHORD_OK, ...)
+ *
+ * Functions never throw or abort on bad input; they report per-item status.
+ * All functions are thread-safe and read the default quality registry.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CYCHORD_ABI_VERSION 1
+
+/* Per-item status codes */
+#define CYCHORD_OK          0
+#define CYCHORD_INVALID     1   /* unparsable symbol or bad record */
+#define CYCHORD_NO_CHORD    2   /* notes form no known chord */
+#define CYCHORD_TRUNCATED   3   /* output buffer too small */
+
+/* cychord_chord.flags */
+#define CYCHORD_FLAG_SLASH     1u   /* 'bass' is a slash note */
+#define CYCHORD_FLAG_APPENDED  2u   /* symbol had appended notes, not kept in the record */
+
+typedef struct cychord_chord {
+    uint16_t mask;      /* pitch classes of the chord, bit 0 = C */
+    uint8_t root;       /* pitch class 0..11 */
+    uint8_t bass;       /* pitch class of the slash note, else the root */
+    int16_t quality;    /* index for cychord_quality_name(), -1 if not a default quality */
+    uint16_t flags;     /* CYCHORD_FLAG_* */
+} cychord_chord;
+
+uint32_t cychord_abi_version(void);
+
+/* The default quality vocabulary; names are NUL-terminated and live forever */
+size_t cychord_quality_count(void);
+const char* cychord_quality_name(size_t index);   /* NULL if out of range */
+
+/**
+ * Parse 'count' chord symbols into 'out'. Returns how many parsed;
+ * status[i] is CYCHORD_OK or CYCHORD_INVALID ('out[i]' zeroed, quality -1).
+ */
+size_t cychord_parse(const char* bytes, const uint32_t* offsets, size_t count,
+                     cychord_chord* out, int32_t* status);
+
+/**
+ * findChordsFromNotes over a batch. Input i is MIDI notes (or pitch
+ * classes) notes[offsets[i] .. offsets[i + 1]). Up to 'per_input' chords
+ * for input i go to out[i * per_input ...], their number to found[i].
+ * Returns the total number of chords written; status[i] is CYCHORD_OK,
+ * CYCHORD_NO_CHORD or CYCHORD_INVALID.
+ */
+size_t cychord_find_chords(const uint8_t* notes, const uint32_t* offsets, size_t count,
+                           size_t per_input, cychord_chord* out, uint32_t* found,
+                           int32_t* status);
+
+/* Transpose records in place by 'semitones' (any sign) */
+void cychord_transpose(cychord_chord* chords, size_t count, int semitones);
+
+/**
+ * Render chord names spelled for 'scale' (a key root such as "C", "Eb",
+ * "F#"; NULL means "C") into 'bytes', laid out like the input buffers:
+ * name i is bytes[offsets[i] .. offsets[i + 1]). Returns the bytes used.
+ * Once 'capacity' runs out the remaining names are empty and marked
+ * CYCHORD_TRUNCATED; records with no default quality are CYCHORD_INVALID.
+ */
+size_t cychord_render(const cychord_chord* chords, size_t count, const char* scale,
+                      char* bytes, size_t capacity, uint32_t* offsets, int32_t* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
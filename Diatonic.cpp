@@ -0,0 +1,230 @@
+#include "Diatonic.hpp"
+#include "Constants.hpp"
+#include "QualityManager.hpp"
+#include "Utils.hpp"
+#include <stdexcept>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+// Names we prefer for diatonic chords, instead of whatever sorts first in the manager
+// (which would give "-" for minor and "M7" for major seventh).
+static const std::vector<std::string> DIATONIC_QUALITY_NAMES = {
+    "", "m", "dim", "aug", "maj7", "m7", "7", "m7b5", "dim7", "mM7", "maj7+5"
+};
+
+static std::string diatonicQualityName(const std::vector<int>& intervals) {
+    auto& manager = QualityManager::Instance();
+    for (const auto& name : DIATONIC_QUALITY_NAMES) {
+        if (!manager.hasQuality(name)) continue;
+        const auto quality = manager.getQuality(name);
+        const auto& candidate = quality->getIntervals();
+        if (std::equal(candidate.begin(), candidate.end(), intervals.begin(), intervals.end())) {
+            return name;
+        }
+    }
+    auto found = manager.findQualityFromComponents(intervals);
+    if (!found) {
+        throw std::runtime_error("No quality registered for diatonic chord.");
+    }
+    return found->getQualityName();
+}
+
+/**
+ * [scaleRoot][mode][degree][seventh] for all 12 x 7 x 7 x 2 diatonic chords.
+ * Built once, on first use, from RELATIVE_KEY_DICT.
+ */
+struct DiatonicTables {
+    DiatonicChord chords[12][7][7][2];
+
+    DiatonicTables() {
+        for (int mode = 0; mode < 7; ++mode) {
+            const auto& pattern = RELATIVE_KEY_DICT.at(MODE_NAMES[mode]);
+            auto wrap = [&](int x) { return pattern[x % 7] + 12 * (x / 7); };
+
+            for (int degree = 0; degree < 7; ++degree) {
+                for (int seventh = 0; seventh < 2; ++seventh) {
+                    std::vector<int> intervals;
+                    int base = wrap(degree);
+                    for (int k = 0; k < (seventh ? 4 : 3); ++k) {
+                        intervals.push_back(wrap(degree + 2 * k) - base);
+                    }
+                    std::string name = diatonicQualityName(intervals);
+
+                    // Chord qualities depend on the mode only; roots on the scale root too
+                    for (int root = 0; root < 12; ++root) {
+                        DiatonicChord& dc = chords[root][mode][degree][seventh];
+                        dc.root = (root + pattern[degree]) % 12;
+                        dc.qualityName = name;
+                        dc.intervals = intervals;
+                    }
+                }
+            }
+        }
+    }
+};
+
+static const DiatonicTables& tables() {
+    static const DiatonicTables instance;
+    return instance;
+}
+
+void parseScale(const std::string& scale, std::string& root, int& mode) {
+    if (scale.size() < 4) {
+        throw std::runtime_error("Scale must be something like Cmaj or Amin, e.g. length>=4");
+    }
+    std::string scaleMode = scale.substr(scale.size() - 3);
+    auto it = std::find(MODE_NAMES.begin(), MODE_NAMES.end(), scaleMode);
+    if (it == MODE_NAMES.end()) {
+        throw std::runtime_error("Unknown scale mode: " + scaleMode);
+    }
+    root = scale.substr(0, scale.size() - 3);
+    noteToVal(root); // validates
+    mode = static_cast<int>(it - MODE_NAMES.begin());
+}
+
+const DiatonicChord& diatonicChord(int scaleRoot, int mode, int degree, bool seventh) {
+    if (degree < 1 || degree > 8) {
+        throw std::runtime_error("Invalid scale degree (must be 1..7 or 8).");
+    }
+    if (mode < 0 || mode >= 7) {
+        throw std::runtime_error("Invalid mode index.");
+    }
+    scaleRoot = ((scaleRoot % 12) + 12) % 12;
+    return tables().chords[scaleRoot][mode][(degree - 1) % 7][seventh ? 1 : 0];
+}
+
+ChordProgression harmonizeDegrees(const std::vector<int>& degrees,
+                                  const std::string& scale,
+                                  bool seventh)
+{
+    std::string scaleRoot;
+    int mode = 0;
+    parseScale(scale, scaleRoot, mode);
+    int rootVal = noteToVal(scaleRoot);
+
+    std::vector<Chord> chords;
+    chords.reserve(degrees.size());
+    for (int degree : degrees) {
+        const DiatonicChord& dc = diatonicChord(rootVal, mode, degree, seventh);
+        chords.push_back(Chord::fromParts(valToNote(dc.root, scaleRoot), dc.qualityName));
+    }
+    return ChordProgression(std::move(chords));
+}
+
+/**
+ * Map a Roman numeral suffix to a quality name. Lower case numerals are minor,
+ * so "ii7" => "m7" while "V7" => "7".
+ */
+static std::string romanQuality(const std::string& suffix, bool minor) {
+    static const std::string HALF_DIM = "\xC3\xB8";  // ø
+    static const std::string DEGREE = "\xC2\xB0";    // °
+
+    if (suffix == "o" || suffix == DEGREE) return "dim";
+    if (suffix == "o7" || suffix == DEGREE + "7") return "dim7";
+    if (suffix == HALF_DIM || suffix == HALF_DIM + "7") return "m7b5";
+    if (suffix == "+") return "aug";
+    if (suffix == "maj7" || suffix == "M7") return minor ? "mM7" : "maj7";
+    if (!minor) return suffix;
+
+    if (suffix.empty()) return "m";
+    if (QualityManager::Instance().hasQuality("m" + suffix)) return "m" + suffix;
+    return suffix;
+}
+
+ChordProgression fromRomanNumerals(const std::string& numerals, const std::string& scale) {
+    static const char* ROMAN_UPPER[] = {"VII", "III", "VI", "IV", "II", "V", "I"};
+    static const char* ROMAN_LOWER[] = {"vii", "iii", "vi", "iv", "ii", "v", "i"};
+    static const int ROMAN_DEGREE[] = {7, 3, 6, 4, 2, 5, 1};
+
+    std::string scaleRoot;
+    int mode = 0;
+    parseScale(scale, scaleRoot, mode);
+    int rootVal = noteToVal(scaleRoot);
+
+    std::vector<Chord> chords;
+    std::istringstream iss(numerals);
+    std::string token;
+    while (iss >> token) {
+        if (token == "|") continue;
+
+        // 1) Accidentals on the root, e.g. "bVII"
+        size_t pos = 0;
+        int alter = 0;
+        while (pos < token.size() && (token[pos] == 'b' || token[pos] == '#')) {
+            alter += (token[pos] == '#') ? 1 : -1;
+            ++pos;
+        }
+
+        // 2) The numeral itself; longest match first
+        int degree = 0;
+        bool minor = false;
+        for (int i = 0; i < 7 && degree == 0; ++i) {
+            if (token.compare(pos, std::strlen(ROMAN_UPPER[i]), ROMAN_UPPER[i]) == 0) {
+                degree = ROMAN_DEGREE[i];
+            } else if (token.compare(pos, std::strlen(ROMAN_LOWER[i]), ROMAN_LOWER[i]) == 0) {
+                degree = ROMAN_DEGREE[i];
+                minor = true;
+            } else {
+                continue;
+            }
+            pos += std::strlen(ROMAN_UPPER[i]);
+        }
+        if (degree == 0) {
+            throw std::runtime_error("Invalid Roman numeral: " + token);
+        }
+
+        const DiatonicChord& dc = diatonicChord(rootVal, mode, degree);
+        std::string root = valToNote(((dc.root + alter) % 12 + 12) % 12, scaleRoot);
+        chords.push_back(Chord::fromParts(root, romanQuality(token.substr(pos), minor)));
+    }
+    return ChordProgression(std::move(chords));
+}
+
+std::string romanNumeral(const Chord& chord, int scaleRoot, int mode) {
+    static const char* ROMAN_BY_DEGREE[] = {"I", "II", "III", "IV", "V", "VI", "VII"};
+
+    if (mode < 0 || mode >= 7) {
+        throw std::runtime_error("Invalid mode index.");
+    }
+    const auto& pattern = RELATIVE_KEY_DICT.at(MODE_NAMES[mode]);
+    int interval = ((noteToVal(chord.rootView()) - scaleRoot) % 12 + 12) % 12;
+
+    // 1) Degree of the root, altered with b/# when it is not in the scale
+    std::string accidental;
+    int degree = -1;
+    for (int d = 0; d < 7 && degree < 0; ++d) {
+        if (pattern[d] == interval) degree = d;
+    }
+    for (int d = 0; d < 7 && degree < 0; ++d) {
+        if (pattern[d] == interval + 1) { degree = d; accidental = "b"; }
+    }
+    for (int d = 0; d < 7 && degree < 0; ++d) {
+        if (pattern[d] == interval - 1) { degree = d; accidental = "#"; }
+    }
+
+    // 2) Quality from the pitch classes above the root
+    unsigned mask = 0;
+    for (int c : chord.quality()->getIntervals()) {
+        mask |= 1u << ((c % 12 + 12) % 12);
+    }
+    auto has = [&](int semitones) { return (mask & (1u << semitones)) != 0; };
+
+    bool minor = has(3) && !has(4);
+    std::string suffix;
+    if (has(4) && has(8) && !has(7)) {
+        suffix = "+";
+    } else if (minor && has(6) && !has(7)) {
+        suffix = has(9) ? "o7" : has(10) ? "\xC3\xB8" "7" : "o";
+    } else if (has(10)) {
+        suffix = "7";
+    } else if (has(11)) {
+        suffix = "maj7";
+    }
+
+    std::string numeral = ROMAN_BY_DEGREE[degree];
+    if (minor) {
+        std::transform(numeral.begin(), numeral.end(), numeral.begin(), ::tolower);
+    }
+    return accidental + numeral + suffix;
+}
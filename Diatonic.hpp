@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * Precomputed diatonic harmony for all 12 roots x 7 modes, and batch
+ * harmonization of scale degrees / Roman numerals into a ChordProgression.
+ */
+
+struct DiatonicChord {
+    int root;                  // pitch class of the chord root (0..11)
+    std::string qualityName;   // e.g. "m7"
+    std::vector<int> intervals; // stacked thirds from the chord root, e.g. {0,3,7,10}
+};
+
+/**
+ * Split a scale like "Cmaj" or "F#Dor" into its root note and mode index
+ * (position in MODE_NAMES). Throws on unknown modes or notes.
+ */
+void parseScale(const std::string& scale, std::string& root, int& mode);
+
+/**
+ * Table lookup: diatonic triad (or seventh) on 'degree' (1..8, 8 == 1)
+ * of the scale rooted at pitch class 'scaleRoot' in mode 'mode'.
+ */
+const DiatonicChord& diatonicChord(int scaleRoot, int mode, int degree, bool seventh = false);
+
+/**
+ * Harmonize a sequence of scale degrees, e.g. {2,5,1} in "Cmaj" => Dm | G | C.
+ */
+ChordProgression harmonizeDegrees(const std::vector<int>& degrees,
+                                  const std::string& scale,
+                                  bool seventh = false);
+
+/**
+ * Build a progression from whitespace-separated Roman numerals, e.g.
+ * "ii7 V7 Imaj7" in "Cmaj" => Dm7 | G7 | Cmaj7.
+ * Case selects major/minor, and the suffix may be "7", "maj7", "o", "o7",
+ * "ø7", "+" or any registered quality name. A leading 'b' or '#' alters the root.
+ */
+ChordProgression fromRomanNumerals(const std::string& numerals, const std::string& scale);
+
+/**
+ * Label a chord with its Roman numeral in a key, e.g. G7 in (0, "maj") => "V7",
+ * Bb in C major => "bVII". Inverse of fromRomanNumerals.
+ */
+std::string romanNumeral(const Chord& chord, int scaleRoot, int mode);
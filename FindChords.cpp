@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include "Constants.hpp"  
+#include "Metrics.hpp"
 
 /**
  * Given a list of notes (e.g. {"C","Eb","G"}), find all chord(s) that match.
@@ -13,88 +14,40 @@
  * 3) Check if those intervals match a known Quality
  * 4) If yes, produce "RootQuality[/OriginalRootIfDifferent]"
  */
-static std::vector<std::vector<std::string>> getAllRotatedNotes(const std::vector<std::string>& notes) {
-    std::vector<std::vector<std::string>> result;
-    result.reserve(notes.size());
-    for (size_t i = 0; i < notes.size(); ++i) {
-        std::vector<std::string> rotated;
-        rotated.insert(rotated.end(), notes.begin() + i, notes.end());
-        rotated.insert(rotated.end(), notes.begin(), notes.begin() + i);
-        result.push_back(rotated);
-    }
-    return result;
-}
-
-static std::vector<int> notesToPositions(const std::vector<std::string>& notes, const std::string& root) {
-    // Mimic Python logic:
+static void notesToPositions(const std::vector<std::string>& notes, std::size_t rotation,
+                             std::vector<int>& positions) {
+    // Mimic Python logic, reading notes[rotation..] then notes[..rotation]:
     // - The first note is root
     // - Then for each subsequent note, if note val < current, add 12
     // - Then store offset from root
-    int rootPos = noteToVal(root);
+    int rootPos = noteToVal(notes[rotation]);
     int currentPos = rootPos;
-    std::vector<int> positions;
-    positions.reserve(notes.size());
-    for (auto &note : notes) {
-        int notePos = noteToVal(note);
+    positions.clear();
+    for (std::size_t k = 0; k < notes.size(); ++k) {
+        int notePos = noteToVal(notes[(rotation + k) % notes.size()]);
         while (notePos < currentPos) {
             notePos += 12;
         }
         positions.push_back(notePos - rootPos);
         currentPos = notePos;
     }
-    return positions;
-}
-
-std::vector<Chord> findChordsFromNotes(const std::vector<std::string>& notes) {
-    if (notes.empty()) {
-        throw std::runtime_error("Please specify notes which form a chord.");
-    }
-    std::string originalRoot = notes[0];
-
-    // We'll gather (rotatedRoot, intervals)
-    // Then see if QualityManager can find a match
-    auto rotations = getAllRotatedNotes(notes);
-
-    std::vector<Chord> results;
-    for (auto &rot : rotations) {
-        std::string rotRoot = rot[0];
-        auto positions = notesToPositions(rot, rotRoot);
-        // find a quality
-        auto q = QualityManager::Instance().findQualityFromComponents(positions);
-        if (q) {
-            // We have a chord. If rotRoot == originalRoot, it's root,
-            // else it's e.g. "rotRootQuality/originalRoot"
-            // We'll build a chord string
-            if (rotRoot == originalRoot) {
-                results.push_back( Chord(rotRoot + q->getQualityName()) );
-            } else {
-                // e.g. "C#m7/G#"
-                std::string chordExpr = rotRoot + q->getQualityName() + "/" + originalRoot;
-                results.push_back( Chord(chordExpr) );
-            }
-        }
-    }
-    return results;
 }
 
-
 /**
- * Overload to handle MIDI notes. We'll:
- * 1) Sort the MIDI note numbers ascending
+ * MIDI notes to note names:
+ * 1) Sort the MIDI note numbers ascending and drop exact duplicates
  * 2) Convert each to semitone (note % 12)
  * 3) Map that semitone to a default note name (e.g. 1 -> "Db")
- * 4) Forward the string-vector to the existing findChordsFromNotes(...)
  */
-std::vector<Chord> findChordsFromNotes(const std::vector<int>& midiNotes)
-{
+static std::vector<std::string> midiToNoteNames(const std::vector<int>& midiNotes) {
     if (midiNotes.empty()) {
         throw std::runtime_error("Please specify at least one MIDI note.");
     }
 
     // 1) Sort
     std::vector<int> sortedNotes = midiNotes;
-    std::unique(sortedNotes.begin(), sortedNotes.end());
     std::sort(sortedNotes.begin(), sortedNotes.end());
+    sortedNotes.erase(std::unique(sortedNotes.begin(), sortedNotes.end()), sortedNotes.end());
 
     // 2) Convert to semitone & pick a default note name for each
     std::vector<std::string> noteNames;
@@ -107,10 +60,89 @@ std::vector<Chord> findChordsFromNotes(const std::vector<int>& midiNotes)
             throw std::runtime_error("No known note name for semitone = " + std::to_string(semitone));
         }
         // pick the first name from e.g. { "Db", "C#" }
-        const std::string& chosenName = it->second.front();
-        noteNames.push_back(chosenName);
+        noteNames.push_back(it->second.front());
+    }
+    return noteNames;
+}
+
+ChordInterpretations::ChordInterpretations(std::vector<std::string> notes, const QualityManager& qualities)
+    : m_qualities(&qualities),
+      m_notes(std::move(notes))
+{
+    if (m_notes.empty()) {
+        throw std::runtime_error("Please specify notes which form a chord.");
+    }
+    m_positions.reserve(m_notes.size());
+}
+
+ChordInterpretations::ChordInterpretations(const std::vector<int>& midiNotes, const QualityManager& qualities)
+    : ChordInterpretations(midiToNoteNames(midiNotes), qualities)
+{
+}
+
+std::optional<Chord> ChordInterpretations::interpret(std::size_t r) {
+    notesToPositions(m_notes, r, m_positions);
+    // find a quality
+    auto q = m_qualities->findQualityFromComponents(m_positions);
+    if (!q) {
+        return std::nullopt;
     }
+    // We have a chord. If the rotated root is the original root, it's root position,
+    // else it's e.g. "rotRootQuality/originalRoot"
+    const std::string& rotRoot = m_notes[r];
+    const std::string& originalRoot = m_notes[0];
+    return Chord::fromParts(rotRoot, q->getQualityName(), rotRoot == originalRoot ? "" : originalRoot,
+                            *m_qualities);
+}
+
+ChordInterpretations::iterator::iterator(ChordInterpretations* range)
+    : m_range(range)
+{
+    ++*this;
+}
+
+ChordInterpretations::iterator& ChordInterpretations::iterator::operator++() {
+    m_current.reset();
+    while (m_range && m_rotation < m_range->m_notes.size()) {
+        m_current = m_range->interpret(m_rotation++);
+        if (m_current) {
+            return *this;
+        }
+    }
+    m_range = nullptr;
+    return *this;
+}
+
+ChordInterpretations::iterator ChordInterpretations::begin() {
+    return iterator(this);
+}
+
+ChordInterpretations::iterator ChordInterpretations::end() {
+    return iterator();
+}
 
-    // 3) Pass them to the existing findChordsFromNotes with strings
-    return findChordsFromNotes(noteNames);
-}
\ No newline at end of file
+std::optional<Chord> ChordInterpretations::first() {
+    auto it = begin();
+    if (it == end()) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::vector<Chord> findChordsFromNotes(const std::vector<std::string>& notes, const QualityManager& qualities) {
+    CYCHORD_METRIC_TIMER(Metric::FindChordsFromNotes);
+    std::vector<Chord> results;
+    for (const Chord& chord : ChordInterpretations(notes, qualities)) {
+        results.push_back(chord);
+    }
+    return results;
+}
+
+/**
+ * Overload to handle MIDI notes: convert them to note names, then
+ * forward the string-vector to the existing findChordsFromNotes(...)
+ */
+std::vector<Chord> findChordsFromNotes(const std::vector<int>& midiNotes, const QualityManager& qualities)
+{
+    return findChordsFromNotes(midiToNoteNames(midiNotes), qualities);
+}
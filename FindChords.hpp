@@ -2,11 +2,76 @@
 
 #include <string>
 #include <vector>
+#include <optional>
+#include <iterator>
+#include <cstddef>
 #include "Chord.hpp"
+#include "QualityManager.hpp"
 
 /**
- * Functions to discover possible Chords from a given set of note names.
+ * Functions to discover possible Chords from a given set of note names,
+ * matched against 'qualities' (the process-wide registry by default).
  */
 
-std::vector<Chord> findChordsFromNotes(const std::vector<std::string>& notes);
-std::vector<Chord> findChordsFromNotes(const std::vector<int>& midiNotes);
\ No newline at end of file
+std::vector<Chord> findChordsFromNotes(const std::vector<std::string>& notes,
+                                       const QualityManager& qualities = QualityManager::Instance());
+std::vector<Chord> findChordsFromNotes(const std::vector<int>& midiNotes,
+                                       const QualityManager& qualities = QualityManager::Instance());
+
+/**
+ * Lazy form of findChordsFromNotes: an input range that yields the same chords,
+ * in the same order (root position first, then each rotation), but only does
+ * the work for an interpretation when the iterator reaches it. Rotations are
+ * read in place instead of copying the note list, and matches are built from
+ * their parts instead of re-parsing a chord string.
+ *
+ *     for (const Chord& c : ChordInterpretations(notes)) { ...; break; }
+ *     auto best = ChordInterpretations(notes).first();
+ */
+class ChordInterpretations {
+public:
+    // 'qualities' must outlive the range
+    explicit ChordInterpretations(std::vector<std::string> notes,
+                                  const QualityManager& qualities = QualityManager::Instance());
+    explicit ChordInterpretations(const std::vector<int>& midiNotes,
+                                  const QualityManager& qualities = QualityManager::Instance());
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Chord;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Chord*;
+        using reference = const Chord&;
+
+        iterator() = default; // end
+        reference operator*() const { return *m_current; }
+        pointer operator->() const { return &*m_current; }
+        iterator& operator++();
+        void operator++(int) { ++*this; }
+        bool operator==(const iterator& other) const { return m_range == other.m_range; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class ChordInterpretations;
+        explicit iterator(ChordInterpretations* range);
+
+        ChordInterpretations* m_range = nullptr; // nullptr once exhausted
+        std::size_t m_rotation = 0;              // next rotation to try
+        std::optional<Chord> m_current;
+    };
+
+    iterator begin();
+    iterator end();
+
+    // Best (first) interpretation only, or nothing if the notes form no chord
+    std::optional<Chord> first();
+
+private:
+    const QualityManager* m_qualities;
+    std::vector<std::string> m_notes;
+    std::vector<int> m_positions; // scratch buffer reused across rotations
+
+    // Try rotation 'r'; on a match return the chord
+    std::optional<Chord> interpret(std::size_t r);
+};
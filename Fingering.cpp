@@ -0,0 +1,269 @@
+#include "Fingering.hpp"
+#include "Constants.hpp"
+#include "Parallel.hpp"
+#include "QualityManager.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+Instrument Instrument::guitar() {
+    return Instrument{"guitar", {40, 45, 50, 55, 59, 64}, 15, 4, 4, true};
+}
+
+Instrument Instrument::ukulele() {
+    return Instrument{"ukulele", {67, 60, 64, 69}, 12, 4, 4, false};
+}
+
+std::string Fingering::toString() const {
+    std::string out;
+    for (int f : frets) {
+        if (f < 0) {
+            out += 'x';
+        } else if (f > 9) {
+            out += "(" + std::to_string(f) + ")";
+        } else {
+            out += static_cast<char>('0' + f);
+        }
+    }
+    return out;
+}
+
+bool Fingering::operator==(const Fingering& other) const {
+    return frets == other.frets;
+}
+
+FingeringFinder::FingeringFinder(const Instrument& instrument, std::size_t maxResults)
+    : m_instrument(instrument), m_maxResults(maxResults)
+{
+    if (instrument.tuning.empty() || instrument.tuning.size() > 12) {
+        throw std::runtime_error("Instrument must have between 1 and 12 strings.");
+    }
+    if (instrument.frets < 0 || instrument.maxStretch < 0 || instrument.fingers < 1) {
+        throw std::runtime_error("Invalid instrument definition: " + instrument.name);
+    }
+}
+
+const Instrument& FingeringFinder::instrument() const {
+    return m_instrument;
+}
+
+std::vector<Fingering> FingeringFinder::fingerings(const Chord& chord) const {
+    int bass = noteToVal(chord.on().empty() ? chord.root() : chord.on());
+    return fingerings(chord.pitchClassMask() | (1u << bass), bass);
+}
+
+std::vector<Fingering> FingeringFinder::fingerings(unsigned pitchClassMask, int bass) const {
+    pitchClassMask &= 0xFFFu;
+    bass = ((bass % 12) + 12) % 12;
+    if (!(pitchClassMask & (1u << bass))) {
+        throw std::runtime_error("Bass note must be part of the pitch-class set.");
+    }
+    const std::uint32_t key = (pitchClassMask << 4) | static_cast<std::uint32_t>(bass);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()) {
+            return it->second;
+        }
+    }
+    std::vector<Fingering> found = search(pitchClassMask, bass);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    return m_cache.emplace(key, std::move(found)).first->second;
+}
+
+/**
+ * Depth-first over strings (muted or any fret sounding a chord tone), pruned
+ * by the stretch limit and by how many chord tones the remaining strings can
+ * still supply. Chords of four or more tones may leave one tone out (more if
+ * there are not enough strings), at a cost.
+ */
+std::vector<Fingering> FingeringFinder::search(unsigned mask, int bass) const {
+    const auto& tuning = m_instrument.tuning;
+    const int strings = static_cast<int>(tuning.size());
+    const int tones = popcount12(mask);
+    const int maxOmitted = tones >= 4 ? std::max(1, tones - strings) : 0;
+    const int minSounding = std::min(3, strings);
+
+    std::vector<Fingering> found;
+    std::vector<int> frets(strings, -1);
+
+    auto evaluate = [&](unsigned covered) {
+        int sounding = 0, fretted = 0, open = 0;
+        int minFret = std::numeric_limits<int>::max(), maxFret = 0;
+        int lowest = std::numeric_limits<int>::max(), first = -1, last = -1;
+        for (int s = 0; s < strings; ++s) {
+            if (frets[s] < 0) continue;
+            ++sounding;
+            if (first < 0) first = s;
+            last = s;
+            lowest = std::min(lowest, tuning[s] + frets[s]);
+            if (frets[s] == 0) {
+                ++open;
+            } else {
+                ++fretted;
+                minFret = std::min(minFret, frets[s]);
+                maxFret = std::max(maxFret, frets[s]);
+            }
+        }
+        if (sounding < minSounding) return;
+        if (m_instrument.bassOnLowest && lowest % 12 != bass) return;
+
+        // More fretted notes than fingers needs a barre across the lowest fret
+        int fingersUsed = fretted;
+        bool barre = false;
+        if (fretted > m_instrument.fingers) {
+            int barreFrom = -1;
+            fingersUsed = 1;
+            for (int s = 0; s < strings; ++s) {
+                if (frets[s] == minFret && barreFrom < 0) barreFrom = s;
+                if (frets[s] > minFret) ++fingersUsed;
+                if (barreFrom >= 0 && frets[s] == 0) return;  // an open string under the barre
+            }
+            if (fingersUsed > m_instrument.fingers) return;
+            barre = true;
+        }
+
+        int innerMutes = 0;
+        for (int s = first; s <= last; ++s) {
+            if (frets[s] < 0) ++innerMutes;
+        }
+        const int omitted = popcount12(mask & ~covered);
+        const int span = fretted ? maxFret - minFret : 0;
+        Fingering fingering;
+        fingering.frets = frets;
+        fingering.barre = barre;
+        fingering.difficulty = 0.5f * fingersUsed + 0.25f * span
+                             + (fretted ? 0.1f * minFret : 0.0f)
+                             + (barre ? 1.0f : 0.0f)
+                             + 1.5f * innerMutes + 1.0f * (strings - sounding)
+                             + 2.0f * omitted - 0.1f * open;
+        found.push_back(std::move(fingering));
+    };
+
+    // s: string to place; covered: chord tones sounded so far
+    auto place = [&](auto& self, int s, unsigned covered, int minFret, int maxFret) -> void {
+        if (popcount12(mask & ~covered) - (strings - s) > maxOmitted) return;
+        if (s == strings) {
+            evaluate(covered);
+            return;
+        }
+        frets[s] = -1;
+        self(self, s + 1, covered, minFret, maxFret);
+        for (int f = 0; f <= m_instrument.frets; ++f) {
+            const int pc = (tuning[s] + f) % 12;
+            if (!(mask & (1u << pc))) continue;
+            int lo = minFret, hi = maxFret;
+            if (f > 0) {
+                lo = std::min(lo, f);
+                hi = std::max(hi, f);
+                if (hi - lo > m_instrument.maxStretch) continue;
+            }
+            frets[s] = f;
+            self(self, s + 1, covered | (1u << pc), lo, hi);
+        }
+        frets[s] = -1;
+    };
+    place(place, 0, 0u, std::numeric_limits<int>::max(), 0);
+
+    std::sort(found.begin(), found.end(), [](const Fingering& a, const Fingering& b) {
+        return a.difficulty != b.difficulty ? a.difficulty < b.difficulty : a.frets < b.frets;
+    });
+    if (m_maxResults && found.size() > m_maxResults) {
+        found.resize(m_maxResults);
+    }
+    return found;
+}
+
+// Hand movement between shapes: fingers sliding on shared strings plus the change of position
+float FingeringFinder::movement(const Fingering& from, const Fingering& to) const {
+    float cost = 0.0f;
+    int fromMin = 0, toMin = 0;
+    for (std::size_t s = 0; s < from.frets.size(); ++s) {
+        if (from.frets[s] > 0 && to.frets[s] > 0) {
+            cost += 0.25f * std::abs(from.frets[s] - to.frets[s]);
+        }
+        if (from.frets[s] > 0 && (fromMin == 0 || from.frets[s] < fromMin)) fromMin = from.frets[s];
+        if (to.frets[s] > 0 && (toMin == 0 || to.frets[s] < toMin)) toMin = to.frets[s];
+    }
+    return cost + 0.5f * std::abs(fromMin - toMin);
+}
+
+std::vector<Fingering> FingeringFinder::smoothest(const ChordProgression& progression) const {
+    const std::size_t n = progression.size();
+    std::vector<std::vector<Fingering>> candidates(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        candidates[i] = fingerings(progression[i]);
+        if (candidates[i].empty()) {
+            throw std::runtime_error("No playable fingering for chord: " + progression[i].chordName());
+        }
+    }
+
+    // Viterbi over the candidate shapes of each chord
+    std::vector<std::vector<float>> cost(n);
+    std::vector<std::vector<std::size_t>> back(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        cost[i].resize(candidates[i].size());
+        back[i].resize(candidates[i].size(), 0);
+        for (std::size_t c = 0; c < candidates[i].size(); ++c) {
+            float best = 0.0f;
+            if (i > 0) {
+                best = std::numeric_limits<float>::max();
+                for (std::size_t p = 0; p < candidates[i - 1].size(); ++p) {
+                    float total = cost[i - 1][p] + movement(candidates[i - 1][p], candidates[i][c]);
+                    if (total < best) {
+                        best = total;
+                        back[i][c] = p;
+                    }
+                }
+            }
+            cost[i][c] = best + candidates[i][c].difficulty;
+        }
+    }
+
+    std::vector<Fingering> result(n);
+    if (n == 0) {
+        return result;
+    }
+    std::size_t c = static_cast<std::size_t>(std::min_element(cost[n - 1].begin(), cost[n - 1].end()) - cost[n - 1].begin());
+    for (std::size_t i = n; i-- > 0;) {
+        result[i] = candidates[i][c];
+        c = back[i][c];
+    }
+    return result;
+}
+
+void FingeringFinder::precompute(const std::vector<std::string>& qualities, unsigned threads) {
+    std::vector<unsigned> masks;
+    if (qualities.empty()) {
+        for (const auto& entry : DEFAULT_QUALITIES) {
+            unsigned mask = 0;
+            for (int interval : entry.second) mask |= 1u << (((interval % 12) + 12) % 12);
+            masks.push_back(mask);
+        }
+    } else {
+        auto& manager = QualityManager::Instance();
+        for (const auto& name : qualities) {
+            auto quality = manager.getQuality(name);
+            unsigned mask = 0;
+            for (int interval : quality->getIntervals()) mask |= 1u << (((interval % 12) + 12) % 12);
+            masks.push_back(mask);
+        }
+    }
+    for (unsigned& mask : masks) mask |= 1u;  // the root is the bass
+    std::sort(masks.begin(), masks.end());
+    masks.erase(std::unique(masks.begin(), masks.end()), masks.end());
+
+    parallelFor(masks.size() * 12, threads, [&](std::size_t i) {
+        const unsigned mask = masks[i / 12];
+        const int root = static_cast<int>(i % 12);
+        fingerings(((mask << root) | (mask >> (12 - root))) & 0xFFFu, root);
+    });
+}
+
+std::size_t FingeringFinder::cacheSize() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_cache.size();
+}
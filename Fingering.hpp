@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * Fingering search for fretted instruments: every playable shape of a chord,
+ * ranked by difficulty, and the smoothest sequence of shapes for a progression.
+ * Results are memoized per (pitch-class set, bass) on each FingeringFinder, so
+ * an instrument's cache can be filled once up front with precompute().
+ */
+
+struct Instrument {
+    std::string name;
+    std::vector<int> tuning;  // MIDI note of each open string, lowest string first
+    int frets = 15;
+    int maxStretch = 4;       // largest fret distance between fretted notes
+    int fingers = 4;
+    bool bassOnLowest = true;  // the lowest sounding note must be the bass (off for re-entrant tunings)
+
+    static Instrument guitar();   // standard E A D G B E
+    static Instrument ukulele();  // G C E A (re-entrant)
+};
+
+struct Fingering {
+    std::vector<int> frets;   // per string: -1 muted, 0 open, otherwise the fret
+    float difficulty = 0.0f;  // lower is easier
+    bool barre = false;
+
+    // Chart notation, e.g. "x32010"; frets above 9 are written in parentheses
+    std::string toString() const;
+    bool operator==(const Fingering& other) const;
+};
+
+class FingeringFinder {
+public:
+    // maxResults caps how many shapes are kept per chord (0 keeps all)
+    explicit FingeringFinder(const Instrument& instrument, std::size_t maxResults = 32);
+
+    const Instrument& instrument() const;
+
+    // Ranked shapes, easiest first; empty if the chord is unplayable
+    std::vector<Fingering> fingerings(const Chord& chord) const;
+    std::vector<Fingering> fingerings(unsigned pitchClassMask, int bass) const;
+
+    /**
+     * Smoothest shapes for a whole progression: minimizes the sum of shape
+     * difficulty and hand movement between consecutive chords. Throws if a
+     * chord has no playable shape.
+     */
+    std::vector<Fingering> smoothest(const ChordProgression& progression) const;
+
+    /**
+     * Fill the cache with every root-position chord of 'qualities' (DEFAULT_QUALITIES
+     * if empty) on the 12 roots, using up to 'threads'
+     * workers (0 = hardware concurrency).
+     */
+    void precompute(const std::vector<std::string>& qualities = {}, unsigned threads = 0);
+    std::size_t cacheSize() const;
+
+private:
+    Instrument m_instrument;
+    std::size_t m_maxResults;
+    mutable std::shared_mutex m_mutex;
+    mutable std::unordered_map<std::uint32_t, std::vector<Fingering>> m_cache;  // key: mask << 4 | bass
+
+    std::vector<Fingering> search(unsigned mask, int bass) const;
+    float movement(const Fingering& from, const Fingering& to) const;
+};
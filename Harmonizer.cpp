@@ -0,0 +1,254 @@
+#include "Harmonizer.hpp"
+#include "Constants.hpp"
+#include "Diatonic.hpp"
+#include "QualityManager.hpp"
+#include "Utils.hpp"
+#include "Parallel.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+
+// Default transition scores by root motion in semitones (log domain).
+// Fourths/fifths are cheapest, tritones most expensive.
+static const float ROOT_MOTION_SCORE[12] = {
+    -0.5f, -1.5f, -1.0f, -1.0f, -1.0f, -0.3f, -2.0f, -0.6f, -1.0f, -1.0f, -1.0f, -1.5f
+};
+// Staying on the very same chord
+static const float REPEAT_SCORE = -0.3f;
+
+HarmonizerModel::HarmonizerModel(const HarmonizerOptions& options)
+    : m_options(options),
+      m_size(12 * options.qualities.size())
+{
+    if (options.qualities.empty()) {
+        throw std::runtime_error("Harmonizer vocabulary needs at least one quality.");
+    }
+
+    // Pitch-class masks of each quality, from its intervals
+    std::vector<unsigned> qualityMasks;
+    for (const auto& name : options.qualities) {
+        unsigned mask = 0;
+        auto quality = QualityManager::Instance().getQuality(name);
+        for (int interval : quality->getIntervals()) {
+            mask |= 1u << (((interval % 12) + 12) % 12);
+        }
+        qualityMasks.push_back(mask);
+    }
+
+    // Pack the vocabulary: root-major, quality-minor
+    m_roots.resize(m_size);
+    m_qualityIndex.resize(m_size);
+    m_masks.resize(m_size);
+    m_templates.resize(m_size * 12);
+    for (std::size_t i = 0; i < m_size; ++i) {
+        int root = static_cast<int>(i / options.qualities.size());
+        int q = static_cast<int>(i % options.qualities.size());
+        // rotate the quality mask up to the root
+        unsigned mask = ((qualityMasks[q] << root) | (qualityMasks[q] >> (12 - root))) & 0xFFFu;
+        m_roots[i] = root;
+        m_qualityIndex[i] = q;
+        m_masks[i] = mask;
+        for (int pc = 0; pc < 12; ++pc) {
+            m_templates[i * 12 + pc] = (mask & (1u << pc)) ? options.chordToneWeight
+                                                            : options.nonChordToneWeight;
+        }
+    }
+
+    buildDefaultTransitions();
+}
+
+void HarmonizerModel::buildDefaultTransitions() {
+    m_transitions.assign(m_size * m_size, 0.0f);
+    for (std::size_t to = 0; to < m_size; ++to) {
+        for (std::size_t from = 0; from < m_size; ++from) {
+            int motion = (m_roots[to] - m_roots[from] + 12) % 12;
+            m_transitions[to * m_size + from] = (to == from) ? REPEAT_SCORE : ROOT_MOTION_SCORE[motion];
+        }
+    }
+}
+
+std::size_t HarmonizerModel::vocabularySize() const {
+    return m_size;
+}
+
+int HarmonizerModel::vocabularyRoot(std::size_t index) const {
+    return m_roots.at(index);
+}
+
+const std::string& HarmonizerModel::vocabularyQuality(std::size_t index) const {
+    return m_options.qualities[m_qualityIndex.at(index)];
+}
+
+float HarmonizerModel::transition(std::size_t from, std::size_t to) const {
+    if (from >= m_size || to >= m_size) {
+        throw std::runtime_error("Index out of range in HarmonizerModel::transition.");
+    }
+    return m_transitions[to * m_size + from];
+}
+
+void HarmonizerModel::setTransition(std::size_t from, std::size_t to, float score) {
+    if (from >= m_size || to >= m_size) {
+        throw std::runtime_error("Index out of range in HarmonizerModel::setTransition.");
+    }
+    m_transitions[to * m_size + from] = score;
+}
+
+/**
+ * Pitch-class duration histograms, 12 floats per chord span.
+ * Notes crossing a span boundary are split between both spans.
+ */
+std::vector<float> HarmonizerModel::segmentHistograms(const std::vector<MelodyNote>& melody) const {
+    std::vector<float> hist;
+    if (m_options.chordDuration <= 0.0) {
+        hist.assign(melody.size() * 12, 0.0f);
+        for (std::size_t i = 0; i < melody.size(); ++i) {
+            if (melody[i].midi >= 0) {
+                hist[i * 12 + melody[i].midi % 12] += static_cast<float>(melody[i].duration);
+            }
+        }
+        return hist;
+    }
+
+    double total = 0.0;
+    for (const auto& n : melody) {
+        total += n.duration;
+    }
+    const double span = m_options.chordDuration;
+    std::size_t segments = static_cast<std::size_t>(std::ceil(total / span - 1e-9));
+    hist.assign(std::max<std::size_t>(segments, 1) * 12, 0.0f);
+
+    double time = 0.0;
+    for (const auto& n : melody) {
+        double remaining = n.duration;
+        while (remaining > 1e-9) {
+            std::size_t seg = std::min(static_cast<std::size_t>(time / span + 1e-9), segments - 1);
+            double take = std::min(remaining, (seg + 1) * span - time);
+            if (take <= 1e-9) take = remaining; // last span absorbs rounding
+            if (n.midi >= 0) {
+                hist[seg * 12 + n.midi % 12] += static_cast<float>(take);
+            }
+            time += take;
+            remaining -= take;
+        }
+    }
+    return hist;
+}
+
+ChordProgression HarmonizerModel::harmonize(const std::vector<MelodyNote>& melody,
+                                            const std::string& scale) const
+{
+    if (melody.empty()) {
+        return ChordProgression();
+    }
+
+    std::string scaleRoot;
+    int mode = 0;
+    parseScale(scale, scaleRoot, mode);
+    int keyVal = noteToVal(scaleRoot);
+
+    // Diatonic membership of each vocabulary entry
+    unsigned scaleMask = 0;
+    const auto& pattern = RELATIVE_KEY_DICT.at(MODE_NAMES[mode]);
+    for (int step : pattern) {
+        scaleMask |= 1u << ((keyVal + step) % 12);
+    }
+    std::vector<float> prior(m_size);
+    for (std::size_t j = 0; j < m_size; ++j) {
+        prior[j] = (m_masks[j] & ~scaleMask) ? m_options.chromaticPenalty : 0.0f;
+    }
+
+    const std::vector<float> hist = segmentHistograms(melody);
+    const std::size_t steps = hist.size() / 12;
+
+    // Emission for every (step, entry): a 12-wide dot product against the templates
+    auto emit = [&](std::size_t t, std::size_t j) {
+        const float* h = &hist[t * 12];
+        const float* w = &m_templates[j * 12];
+        float s = 0.0f;
+        for (int pc = 0; pc < 12; ++pc) {
+            s += h[pc] * w[pc];
+        }
+        return s + prior[j];
+    };
+
+    const float NEG_INF = -std::numeric_limits<float>::infinity();
+    std::vector<float> delta(m_size), next(m_size);
+    std::vector<int> back(steps * m_size, 0);
+    for (std::size_t j = 0; j < m_size; ++j) {
+        delta[j] = emit(0, j);
+    }
+
+    const bool pruning = m_options.beamWidth > 0 && m_options.beamWidth < m_size;
+    std::vector<int> beam(m_size);
+    std::vector<float> candidates(m_size);
+
+    for (std::size_t t = 1; t < steps; ++t) {
+        std::iota(beam.begin(), beam.end(), 0);
+        std::size_t width = m_size;
+        if (pruning) {
+            width = m_options.beamWidth;
+            std::nth_element(beam.begin(), beam.begin() + width, beam.end(),
+                             [&](int a, int b) { return delta[a] > delta[b]; });
+        }
+
+        for (std::size_t j = 0; j < m_size; ++j) {
+            const float* trans = &m_transitions[j * m_size];
+            float best = NEG_INF;
+            int arg = 0;
+            if (!pruning) {
+                // dense row: a plain max reduction the compiler can vectorize
+                for (std::size_t i = 0; i < m_size; ++i) {
+                    candidates[i] = delta[i] + trans[i];
+                }
+                for (std::size_t i = 0; i < m_size; ++i) {
+                    best = std::max(best, candidates[i]);
+                }
+                arg = static_cast<int>(std::find(candidates.begin(), candidates.end(), best) - candidates.begin());
+            } else {
+                for (std::size_t k = 0; k < width; ++k) {
+                    int i = beam[k];
+                    float v = delta[i] + trans[i];
+                    if (v > best) {
+                        best = v;
+                        arg = i;
+                    }
+                }
+            }
+            next[j] = best + emit(t, j);
+            back[t * m_size + j] = arg;
+        }
+        delta.swap(next);
+    }
+
+    // Backtrack
+    std::vector<int> path(steps);
+    path[steps - 1] = static_cast<int>(std::max_element(delta.begin(), delta.end()) - delta.begin());
+    for (std::size_t t = steps - 1; t > 0; --t) {
+        path[t - 1] = back[t * m_size + path[t]];
+    }
+
+    std::vector<Chord> chords;
+    chords.reserve(steps);
+    for (int j : path) {
+        chords.push_back(Chord::fromParts(valToNote(m_roots[j], scaleRoot),
+                                          m_options.qualities[m_qualityIndex[j]]));
+    }
+    return ChordProgression(std::move(chords));
+}
+
+std::vector<ChordProgression> harmonizeBatch(const HarmonizerModel& model,
+                                             const std::vector<std::vector<MelodyNote>>& melodies,
+                                             const std::vector<std::string>& scales,
+                                             unsigned threads)
+{
+    if (melodies.size() != scales.size()) {
+        throw std::runtime_error("harmonizeBatch needs one scale per melody.");
+    }
+    std::vector<ChordProgression> results(melodies.size());
+    parallelFor(melodies.size(), threads, [&](std::size_t i) {
+        results[i] = model.harmonize(melodies[i], scales[i]);
+    });
+    return results;
+}
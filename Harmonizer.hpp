@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "ChordProgression.hpp"
+
+/**
+ * Melody harmonization: pick the most likely ChordProgression for a melody
+ * in a given key, by Viterbi decoding over a packed chord vocabulary.
+ */
+
+struct MelodyNote {
+    int midi;         // MIDI note number, negative for a rest
+    double duration;  // in beats (or any unit, as long as chordDuration uses the same)
+};
+
+struct HarmonizerOptions {
+    // Qualities making up the vocabulary, on every one of the 12 roots
+    std::vector<std::string> qualities = {"", "m", "dim", "aug"};
+    // Length of one chord span; 0 means one chord per melody note
+    double chordDuration = 0.0;
+    // Emission weights, per unit of duration
+    float chordToneWeight = 1.0f;
+    float nonChordToneWeight = -1.0f;
+    // Added to chords with tones outside the key (RELATIVE_KEY_DICT)
+    float chromaticPenalty = -2.0f;
+    // Keep only the best 'beamWidth' states per step; 0 keeps all
+    std::size_t beamWidth = 0;
+};
+
+class HarmonizerModel {
+public:
+    explicit HarmonizerModel(const HarmonizerOptions& options = HarmonizerOptions());
+
+    // Most likely progression for 'melody' in 'scale' (e.g. "Cmaj", "Amin")
+    ChordProgression harmonize(const std::vector<MelodyNote>& melody, const std::string& scale) const;
+
+    // Vocabulary: entry i is root (i / qualities) with quality (i % qualities)
+    std::size_t vocabularySize() const;
+    int vocabularyRoot(std::size_t index) const;
+    const std::string& vocabularyQuality(std::size_t index) const;
+
+    // Transition score (log domain) between two vocabulary entries
+    float transition(std::size_t from, std::size_t to) const;
+    void setTransition(std::size_t from, std::size_t to, float score);
+
+private:
+    HarmonizerOptions m_options;
+    std::size_t m_size;
+    std::vector<int> m_roots;          // pitch class per entry
+    std::vector<int> m_qualityIndex;   // index into m_options.qualities per entry
+    std::vector<unsigned> m_masks;     // pitch-class bitmask per entry
+    std::vector<float> m_templates;    // size x 12 emission weights
+    std::vector<float> m_transitions;  // size x size, stored as [to * size + from]
+
+    void buildDefaultTransitions();
+    std::vector<float> segmentHistograms(const std::vector<MelodyNote>& melody) const;
+};
+
+/**
+ * Harmonize many songs at once; melodies[i] is in scales[i].
+ * Songs are spread over 'threads' workers (0 = hardware concurrency).
+ */
+std::vector<ChordProgression> harmonizeBatch(const HarmonizerModel& model,
+                                             const std::vector<std::vector<MelodyNote>>& melodies,
+                                             const std::vector<std::string>& scales,
+                                             unsigned threads = 0);
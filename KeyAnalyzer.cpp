@@ -0,0 +1,180 @@
+#include "KeyAnalyzer.hpp"
+#include "Constants.hpp"
+#include "Diatonic.hpp"
+#include "Parallel.hpp"
+#include "Utils.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+// Krumhansl-Kessler probe-tone profiles, tonic first, scaled by 100
+static const int MAJOR_PROFILE[12] = {
+    635, 223, 348, 233, 438, 409, 252, 519, 239, 366, 229, 288
+};
+static const int MINOR_PROFILE[12] = {
+    633, 268, 352, 538, 260, 353, 254, 475, 398, 269, 334, 317
+};
+
+// Scale of the integer rows; integers keep the running window sums exact however long the stream gets
+static const int PROFILE_SCALE = 10000;
+
+/**
+ * PROFILE_BY_PC[pc][key]: how much one sounding pitch class adds to each key's score.
+ * Each profile is mean-centered and scaled to unit norm, so a key's score
+ * divided by the norm of the centered counts is their Pearson correlation, as
+ * in Krumhansl-Kessler; raw profiles would favor minor, whose mass is larger.
+ * The score is linear in the pitch-class counts, so adding or dropping a
+ * chord is a sum of these rows.
+ */
+struct ProfileTable {
+    double weights[12][24];
+    int rows[12][24];
+
+    ProfileTable() {
+        double major[12];
+        double minor[12];
+        normalize(MAJOR_PROFILE, major);
+        normalize(MINOR_PROFILE, minor);
+        for (int pc = 0; pc < 12; ++pc) {
+            for (int tonic = 0; tonic < 12; ++tonic) {
+                int degree = (pc - tonic + 12) % 12;
+                weights[pc][tonic] = major[degree];
+                weights[pc][12 + tonic] = minor[degree];
+            }
+            for (int k = 0; k < 24; ++k) {
+                rows[pc][k] = static_cast<int>(std::lround(weights[pc][k] * PROFILE_SCALE));
+            }
+        }
+    }
+
+    static void normalize(const int* profile, double* out) {
+        double mean = 0.0;
+        for (int i = 0; i < 12; ++i) mean += profile[i];
+        mean /= 12.0;
+        double norm = 0.0;
+        for (int i = 0; i < 12; ++i) {
+            out[i] = profile[i] - mean;
+            norm += out[i] * out[i];
+        }
+        norm = std::sqrt(norm);
+        for (int i = 0; i < 12; ++i) out[i] /= norm;
+    }
+};
+
+static const ProfileTable PROFILE_BY_PC;
+
+KeyAnalyzer::KeyAnalyzer(std::size_t window)
+    : m_window(window),
+      m_history(window, 0),
+      m_head(0),
+      m_count(0)
+{
+    if (window == 0) {
+        throw std::runtime_error("KeyAnalyzer window must be at least 1.");
+    }
+    std::fill(m_scores, m_scores + 24, 0);
+    std::fill(m_counts, m_counts + 12, 0);
+}
+
+void KeyAnalyzer::reset() {
+    std::fill(m_history.begin(), m_history.end(), 0u);
+    std::fill(m_scores, m_scores + 24, 0);
+    std::fill(m_counts, m_counts + 12, 0);
+    m_head = 0;
+    m_count = 0;
+}
+
+std::size_t KeyAnalyzer::window() const {
+    return m_window;
+}
+
+const int* KeyAnalyzer::scores() const {
+    return m_scores;
+}
+
+void KeyAnalyzer::apply(unsigned mask, int sign) {
+    for (int pc = 0; pc < 12; ++pc) {
+        if (mask & (1u << pc)) {
+            m_counts[pc] += sign;
+            const int* row = PROFILE_BY_PC.rows[pc];
+            for (int k = 0; k < 24; ++k) {
+                m_scores[k] += sign * row[k];
+            }
+        }
+    }
+}
+
+KeyLabel KeyAnalyzer::push(const Chord& chord) {
+    unsigned mask = chord.pitchClassMask();
+
+    // Slide the window: drop the oldest chord once it is full
+    if (m_count == m_window) {
+        apply(m_history[m_head], -1);
+    } else {
+        ++m_count;
+    }
+    m_history[m_head] = mask;
+    m_head = (m_head + 1) % m_window;
+    apply(mask, 1);
+
+    int best = static_cast<int>(std::max_element(m_scores, m_scores + 24) - m_scores);
+
+    KeyLabel label;
+    label.tonic = best % 12;
+    label.minor = best >= 12;
+    label.score = correlation(m_scores[best]);
+
+    // The relative major decides flats vs sharps, e.g. D minor => F => flats
+    int mode = label.minor ? 5 : 0; // MODE_NAMES: "maj", ..., "min"
+    std::string relativeMajor = valToNote(label.minor ? (label.tonic + 3) % 12 : label.tonic);
+    label.key = valToNote(label.tonic, relativeMajor) + MODE_NAMES[mode];
+    label.roman = romanNumeral(chord, label.tonic, mode);
+    return label;
+}
+
+// Pearson correlation of the window's pitch-class counts with a key whose score is 'score'
+float KeyAnalyzer::correlation(int score) const {
+    double sum = 0.0;
+    double squares = 0.0;
+    for (int pc = 0; pc < 12; ++pc) {
+        sum += m_counts[pc];
+        squares += static_cast<double>(m_counts[pc]) * m_counts[pc];
+    }
+    const double spread = squares - sum * sum / 12.0;
+    if (spread <= 0.0) {
+        return 0.0f;  // all pitch classes equally present: no key stands out
+    }
+    return static_cast<float>(score / (PROFILE_SCALE * std::sqrt(spread)));
+}
+
+int estimateKey(const std::uint64_t* pitchClassCounts) {
+    double scores[24] = {};
+    for (int pc = 0; pc < 12; ++pc) {
+        const double count = static_cast<double>(pitchClassCounts[pc]);
+        for (int k = 0; k < 24; ++k) {
+            scores[k] += count * PROFILE_BY_PC.weights[pc][k];
+        }
+    }
+    return static_cast<int>(std::max_element(scores, scores + 24) - scores);
+}
+
+std::vector<KeyLabel> analyzeKeys(const ChordProgression& progression, std::size_t window) {
+    KeyAnalyzer analyzer(window);
+    std::vector<KeyLabel> labels;
+    labels.reserve(progression.size());
+    for (const auto& chord : progression.chords()) {
+        labels.push_back(analyzer.push(chord));
+    }
+    return labels;
+}
+
+std::vector<std::vector<KeyLabel>> analyzeKeysBatch(const std::vector<ChordProgression>& songs,
+                                                    std::size_t window,
+                                                    unsigned threads)
+{
+    std::vector<std::vector<KeyLabel>> results(songs.size());
+    parallelFor(songs.size(), threads, [&](std::size_t i) {
+        results[i] = analyzeKeys(songs[i], window);
+    });
+    return results;
+}
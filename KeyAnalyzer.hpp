@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "ChordProgression.hpp"
+
+/**
+ * Streaming key and Roman-numeral analysis over a sliding window of chords,
+ * correlating pitch-class counts with the Krumhansl-Kessler key profiles.
+ */
+
+struct KeyLabel {
+    int tonic;           // pitch class of the key's tonic
+    bool minor;          // minor (Aeolian) or major (Ionian) key
+    std::string key;     // e.g. "Cmaj", "F#min"
+    std::string roman;   // the chord's Roman numeral in that key, e.g. "V7"
+    float score;         // correlation of the window with the winning key's profile, -1..1
+};
+
+class KeyAnalyzer {
+public:
+    explicit KeyAnalyzer(std::size_t window = 8);
+
+    /**
+     * Feed the next chord and label it. The window's key scores are updated
+     * incrementally: the new chord's tones are added and the oldest chord's
+     * removed, so each call costs O(24 * notes) regardless of window size.
+     */
+    KeyLabel push(const Chord& chord);
+
+    // Forget everything seen so far
+    void reset();
+
+    std::size_t window() const;
+
+    /**
+     * Current score of each key: the window's pitch-class counts dotted with the
+     * key's mean-centered, unit-norm profile (x10000). Proportional to the
+     * correlation, so keys compare directly. [0..11] major on C..B, [12..23] minor.
+     */
+    const int* scores() const;
+
+private:
+    std::size_t m_window;
+    std::vector<unsigned> m_history; // ring buffer of pitch-class masks
+    std::size_t m_head;
+    std::size_t m_count;
+    int m_scores[24];
+    int m_counts[12];                // pitch-class counts in the window
+
+    void apply(unsigned mask, int sign);
+    float correlation(int score) const;
+};
+
+/**
+ * Whole-passage key from how often each pitch class sounds (counts[0] = C):
+ * index of the best of the 24 key scores, as in KeyAnalyzer::scores().
+ */
+int estimateKey(const std::uint64_t* pitchClassCounts);
+
+// Label every chord of a progression
+std::vector<KeyLabel> analyzeKeys(const ChordProgression& progression, std::size_t window = 8);
+
+// Batch mode: songs are analyzed independently on up to 'threads' workers
+std::vector<std::vector<KeyLabel>> analyzeKeysBatch(const std::vector<ChordProgression>& songs,
+                                                    std::size_t window = 8,
+                                                    unsigned threads = 0);
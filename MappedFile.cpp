@@ -0,0 +1,88 @@
+#include "MappedFile.hpp"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CYCHORD_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef CYCHORD_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read file: " + path);
+    }
+    if (st.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        m_mapping = mapping;
+        m_data = static_cast<const char*>(mapping);
+        m_size = static_cast<std::size_t>(st.st_size);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_buffer = std::move(other.m_buffer);  // storage moves with the vector
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_mapping = other.m_mapping;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_mapping = nullptr;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+#ifdef CYCHORD_HAVE_MMAP
+    if (m_mapping) {
+        munmap(m_mapping, m_size);
+    }
+#endif
+    m_mapping = nullptr;
+    m_buffer.clear();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const char* MappedFile::data() const {
+    return m_data;
+}
+
+std::size_t MappedFile::size() const {
+    return m_size;
+}
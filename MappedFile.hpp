@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Read-only view of a whole file. On POSIX systems the file is mapped
+ * (pages are loaded on first touch and shared between processes); elsewhere
+ * it is read into memory. Throws std::runtime_error if the file cannot be read.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const;
+    std::size_t size() const;
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    void* m_mapping = nullptr;
+    std::vector<char> m_buffer;  // fallback when mapping is unavailable
+
+    void release();
+};
@@ -0,0 +1,180 @@
+#include "Metrics.hpp"
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+static const int METRIC_COUNT = static_cast<int>(Metric::Count);
+
+const char* metricName(Metric metric) {
+    static const char* NAMES[] = {
+        "parseChord",
+        "QualityManager::getQuality",
+        "findQualityFromComponents.exact",
+        "findQualityFromComponents.subset",
+        "findQualityFromComponents.miss",
+        "findChordsFromNotes",
+        "Chord::transpose",
+    };
+    int index = static_cast<int>(metric);
+    return (index >= 0 && index < METRIC_COUNT) ? NAMES[index] : "unknown";
+}
+
+#ifdef CYCHORD_METRICS
+
+/**
+ * One thread's counters. Only the owning thread writes them, so relaxed
+ * load+store is enough and no read-modify-write is needed on the hot path;
+ * snapshot() reads them from other threads.
+ */
+struct ThreadMetrics {
+    std::atomic<std::uint64_t> calls[METRIC_COUNT];
+    std::atomic<std::uint64_t> totalNanos[METRIC_COUNT];
+    std::atomic<std::uint64_t> histogram[METRIC_COUNT][METRIC_BUCKETS];
+
+    ThreadMetrics();
+    ~ThreadMetrics();
+
+    void addTo(MetricsSnapshot& snap) const {
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            snap.stats[m].calls += calls[m].load(std::memory_order_relaxed);
+            snap.stats[m].totalNanos += totalNanos[m].load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < METRIC_BUCKETS; ++b) {
+                snap.stats[m].histogram[b] += histogram[m][b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void clear() {
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            calls[m].store(0, std::memory_order_relaxed);
+            totalNanos[m].store(0, std::memory_order_relaxed);
+            for (std::size_t b = 0; b < METRIC_BUCKETS; ++b) {
+                histogram[m][b].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Live threads, plus the totals of threads that have already exited
+struct MetricsRegistry {
+    std::mutex mutex;
+    std::vector<ThreadMetrics*> threads;
+    MetricsSnapshot retired;
+};
+
+static MetricsRegistry& registry() {
+    // leaked on purpose: thread_local destructors may run after static destruction
+    static MetricsRegistry* instance = new MetricsRegistry();
+    return *instance;
+}
+
+ThreadMetrics::ThreadMetrics() {
+    clear();
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.threads.push_back(this);
+}
+
+ThreadMetrics::~ThreadMetrics() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    addTo(reg.retired);
+    reg.threads.erase(std::remove(reg.threads.begin(), reg.threads.end(), this), reg.threads.end());
+}
+
+static ThreadMetrics& threadMetrics() {
+    thread_local ThreadMetrics metrics;
+    return metrics;
+}
+
+static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+void recordMetric(Metric metric, std::int64_t nanos) {
+    ThreadMetrics& t = threadMetrics();
+    int m = static_cast<int>(metric);
+    bump(t.calls[m], 1);
+    if (nanos < 0) {
+        return;
+    }
+    bump(t.totalNanos[m], static_cast<std::uint64_t>(nanos));
+    std::size_t bucket = 0;
+    for (std::uint64_t v = static_cast<std::uint64_t>(nanos); v > 1 && bucket + 1 < METRIC_BUCKETS; v >>= 1) {
+        ++bucket;
+    }
+    bump(t.histogram[m][bucket], 1);
+}
+
+MetricsSnapshot metricsSnapshot() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    MetricsSnapshot snap = reg.retired;
+    snap.enabled = true;
+    for (const ThreadMetrics* t : reg.threads) {
+        t->addTo(snap);
+    }
+    return snap;
+}
+
+void resetMetrics() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.retired = MetricsSnapshot();
+    for (ThreadMetrics* t : reg.threads) {
+        t->clear();
+    }
+}
+
+#else
+
+MetricsSnapshot metricsSnapshot() {
+    return MetricsSnapshot();
+}
+
+void resetMetrics() {
+}
+
+#endif
+
+std::string MetricsSnapshot::toText() const {
+    std::ostringstream oss;
+    if (!enabled) {
+        oss << "metrics disabled (build with -DCYCHORD_METRICS)\n";
+        return oss.str();
+    }
+    for (int m = 0; m < METRIC_COUNT; ++m) {
+        const MetricStats& s = stats[m];
+        oss << metricName(static_cast<Metric>(m)) << ": calls=" << s.calls;
+        if (s.totalNanos > 0) {
+            oss << " total_ns=" << s.totalNanos
+                << " mean_ns=" << (s.calls ? s.totalNanos / s.calls : 0);
+        }
+        oss << "\n";
+        for (std::size_t b = 0; b < METRIC_BUCKETS; ++b) {
+            if (s.histogram[b]) {
+                oss << "  <" << (std::uint64_t(1) << (b + 1)) << "ns: " << s.histogram[b] << "\n";
+            }
+        }
+    }
+    return oss.str();
+}
+
+std::string MetricsSnapshot::toJson() const {
+    std::ostringstream oss;
+    oss << "{\"enabled\":" << (enabled ? "true" : "false") << ",\"metrics\":{";
+    for (int m = 0; m < METRIC_COUNT; ++m) {
+        const MetricStats& s = stats[m];
+        if (m > 0) oss << ",";
+        oss << "\"" << metricName(static_cast<Metric>(m)) << "\":{"
+            << "\"calls\":" << s.calls << ",\"total_ns\":" << s.totalNanos << ",\"histogram\":[";
+        for (std::size_t b = 0; b < METRIC_BUCKETS; ++b) {
+            if (b > 0) oss << ",";
+            oss << s.histogram[b];
+        }
+        oss << "]}";
+    }
+    oss << "}}";
+    return oss.str();
+}
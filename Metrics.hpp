@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Opt-in hot-path instrumentation: per-thread call counters and latency
+ * histograms for the chord-processing entry points.
+ *
+ * Build with -DCYCHORD_METRICS to enable. Without it the CYCHORD_METRIC_*
+ * macros expand to nothing, so release builds pay no cost; the snapshot API
+ * below still links and reports enabled == false.
+ */
+
+enum class Metric : int {
+    ParseChord = 0,
+    GetQuality,
+    FindQualityExact,     // findQualityFromComponents resolved by exact match
+    FindQualitySubset,    // ... resolved by the subset pass
+    FindQualityMiss,      // ... found nothing
+    FindChordsFromNotes,
+    Transpose,
+    Count
+};
+
+// Latency buckets: bucket b counts calls taking [2^b, 2^(b+1)) ns; the last is open-ended
+constexpr std::size_t METRIC_BUCKETS = 32;
+
+struct MetricStats {
+    std::uint64_t calls = 0;
+    std::uint64_t totalNanos = 0;
+    std::uint64_t histogram[METRIC_BUCKETS] = {};
+};
+
+struct MetricsSnapshot {
+    bool enabled = false;
+    MetricStats stats[static_cast<int>(Metric::Count)];
+
+    std::string toText() const;
+    std::string toJson() const;
+};
+
+// Sum of all threads' counters, including threads that have exited
+MetricsSnapshot metricsSnapshot();
+// Zero every counter (concurrent updates may land on either side of the reset)
+void resetMetrics();
+const char* metricName(Metric metric);
+
+#ifdef CYCHORD_METRICS
+
+// Record one call; nanos < 0 means "count only"
+void recordMetric(Metric metric, std::int64_t nanos);
+
+class ScopedMetricTimer {
+public:
+    explicit ScopedMetricTimer(Metric metric)
+        : m_metric(metric),
+          m_start(std::chrono::steady_clock::now())
+    {
+    }
+    ~ScopedMetricTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        recordMetric(m_metric, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    // Decide late which metric the call counts towards (e.g. exact vs subset hit)
+    void retag(Metric metric) { m_metric = metric; }
+
+    ScopedMetricTimer(const ScopedMetricTimer&) = delete;
+    ScopedMetricTimer& operator=(const ScopedMetricTimer&) = delete;
+
+private:
+    Metric m_metric;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define CYCHORD_METRIC_CONCAT_(a, b) a##b
+#define CYCHORD_METRIC_CONCAT(a, b) CYCHORD_METRIC_CONCAT_(a, b)
+#define CYCHORD_METRIC_TIMER(metric) \
+    ScopedMetricTimer CYCHORD_METRIC_CONCAT(cychordMetricTimer_, __LINE__)(metric)
+#define CYCHORD_METRIC_SCOPE(name, metric) ScopedMetricTimer name(metric)
+#define CYCHORD_METRIC_RETAG(name, metric) name.retag(metric)
+#define CYCHORD_METRIC_COUNT(metric) recordMetric(metric, -1)
+
+#else
+
+#define CYCHORD_METRIC_TIMER(metric) ((void)0)
+#define CYCHORD_METRIC_SCOPE(name, metric) ((void)0)
+#define CYCHORD_METRIC_RETAG(name, metric) ((void)0)
+#define CYCHORD_METRIC_COUNT(metric) ((void)0)
+
+#endif
@@ -0,0 +1,258 @@
+#include "MidiWriter.hpp"
+#include "Parallel.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+// MThd chunk (14 bytes) plus the MTrk chunk header (8 bytes)
+static const std::size_t HEADER_SIZE = 22;
+// Largest channel event: 4-byte delta time, status, two data bytes
+static const std::size_t MAX_EVENT_SIZE = 7;
+// Tempo meta event, program change, end-of-track meta event
+static const std::size_t FIXED_EVENTS_SIZE = 7 + 3 + 4;
+static const std::uint32_t MAX_DELTA = 0x0FFFFFFF;
+
+// Most notes one chord can produce: its tones plus the optional bass
+static const std::size_t MAX_VOICES = Chord::MAX_COMPONENTS + 1;
+
+static void putU32(std::uint8_t* out, std::uint32_t v) {
+    out[0] = static_cast<std::uint8_t>(v >> 24);
+    out[1] = static_cast<std::uint8_t>(v >> 16);
+    out[2] = static_cast<std::uint8_t>(v >> 8);
+    out[3] = static_cast<std::uint8_t>(v);
+}
+
+static std::uint8_t* putVarLen(std::uint8_t* out, std::uint32_t v) {
+    if (v > MAX_DELTA) {
+        throw std::runtime_error("MIDI delta time too large.");
+    }
+    if (v >= 1u << 21) *out++ = static_cast<std::uint8_t>(0x80 | (v >> 21));
+    if (v >= 1u << 14) *out++ = static_cast<std::uint8_t>(0x80 | ((v >> 14) & 0x7F));
+    if (v >= 1u << 7) *out++ = static_cast<std::uint8_t>(0x80 | ((v >> 7) & 0x7F));
+    *out++ = static_cast<std::uint8_t>(v & 0x7F);
+    return out;
+}
+
+// MIDI notes for one chord under the voicing policy, ascending; returns the count
+static std::size_t voiceChord(const Chord& chord, const MidiRenderOptions& options, int* notes) {
+    std::size_t n = chord.pitches(options.rootOctave, notes, Chord::MAX_COMPONENTS);
+    const int root = 12 * (options.rootOctave + 1) + noteToVal(chord.rootView());
+    if (options.voicing != MidiVoicing::Root) {
+        for (std::size_t i = 0; i < n; ++i) {
+            notes[i] = root + ((notes[i] - root) % 12 + 12) % 12;
+        }
+    }
+    std::sort(notes, notes + n);
+    n = static_cast<std::size_t>(std::unique(notes, notes + n) - notes);
+    if (options.voicing == MidiVoicing::Drop2 && n >= 3) {
+        notes[n - 2] -= 12;
+        std::sort(notes, notes + n);
+    }
+    if (options.addBass && n > 0) {
+        const std::string_view on = chord.onView();
+        int bass = 12 * (options.rootOctave + 1) + noteToVal(on.empty() ? chord.rootView() : on);
+        while (bass >= notes[0]) bass -= 12;
+        std::copy_backward(notes, notes + n, notes + n + 1);
+        notes[0] = bass;
+        ++n;
+    }
+    // Drop whatever the octave choice pushed out of MIDI range
+    return static_cast<std::size_t>(
+        std::remove_if(notes, notes + n, [](int note) { return note < 0 || note > 127; }) - notes);
+}
+
+std::size_t midiSizeBound(const ChordProgression& progression, const MidiRenderOptions& options) {
+    std::size_t notes = 0;
+    for (const Chord& chord : progression.chords()) {
+        notes += chord.componentCount() + (options.addBass ? 1 : 0);
+    }
+    return HEADER_SIZE + FIXED_EVENTS_SIZE + 2 * notes * MAX_EVENT_SIZE;
+}
+
+std::size_t encodeMidi(const ChordProgression& progression, const std::vector<double>& durations,
+                       const MidiRenderOptions& options, std::uint8_t* out, std::size_t capacity) {
+    const std::size_t count = progression.size();
+    if (count > 0 && durations.size() != count && durations.size() != 1) {
+        throw std::runtime_error("encodeMidi needs one duration per chord, or a single duration.");
+    }
+    if (options.ticksPerBeat == 0 || options.ticksPerBeat >= 0x8000) {
+        throw std::runtime_error("ticksPerBeat must be in 1..32767.");
+    }
+    if (capacity < midiSizeBound(progression, options)) {
+        throw std::runtime_error("MIDI buffer smaller than midiSizeBound().");
+    }
+
+    std::uint8_t* p = out + HEADER_SIZE;
+    const std::uint8_t channel = options.channel & 0x0F;
+
+    // Meta events cancel running status, so they all go before the first note
+    *p++ = 0x00; *p++ = 0xFF; *p++ = 0x51; *p++ = 0x03;
+    *p++ = static_cast<std::uint8_t>(options.tempo >> 16);
+    *p++ = static_cast<std::uint8_t>(options.tempo >> 8);
+    *p++ = static_cast<std::uint8_t>(options.tempo);
+    if (options.program >= 0) {
+        *p++ = 0x00;
+        *p++ = static_cast<std::uint8_t>(0xC0 | channel);
+        *p++ = static_cast<std::uint8_t>(options.program & 0x7F);
+    }
+
+    const std::uint8_t noteOn = static_cast<std::uint8_t>(0x90 | channel);
+    std::uint8_t status = 0;
+    long long lastTick = 0;
+    auto event = [&](long long tick, int note, std::uint8_t velocity) {
+        p = putVarLen(p, static_cast<std::uint32_t>(tick - lastTick));
+        lastTick = tick;
+        if (status != noteOn) {
+            *p++ = noteOn;
+            status = noteOn;
+        }
+        *p++ = static_cast<std::uint8_t>(note);
+        *p++ = velocity;
+    };
+
+    // Offs for the sounding chord are written when the next one starts
+    int sounding[MAX_VOICES];
+    std::size_t soundingCount = 0;
+    const std::uint8_t velocity = std::max<std::uint8_t>(1, options.velocity & 0x7F);
+    double beats = 0.0;
+    long long end = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double duration = durations.size() == 1 ? durations[0] : durations[i];
+        if (!(duration >= 0.0) || !std::isfinite(duration)) {
+            throw std::runtime_error("Chord durations must be finite and non-negative.");
+        }
+        const long long start = end;
+        beats += duration;
+        end = std::llround(beats * options.ticksPerBeat);
+        if (end == start) continue;
+
+        for (std::size_t v = 0; v < soundingCount; ++v) event(start, sounding[v], 0);
+        soundingCount = voiceChord(progression[i], options, sounding);
+        for (std::size_t v = 0; v < soundingCount; ++v) event(start, sounding[v], velocity);
+    }
+    for (std::size_t v = 0; v < soundingCount; ++v) event(end, sounding[v], 0);
+
+    // End of track, then the headers in front now that the length is known
+    p = putVarLen(p, static_cast<std::uint32_t>(end - lastTick));
+    *p++ = 0xFF; *p++ = 0x2F; *p++ = 0x00;
+
+    std::memcpy(out, "MThd", 4);
+    putU32(out + 4, 6);
+    out[8] = 0; out[9] = 0;     // format 0
+    out[10] = 0; out[11] = 1;   // one track
+    out[12] = static_cast<std::uint8_t>(options.ticksPerBeat >> 8);
+    out[13] = static_cast<std::uint8_t>(options.ticksPerBeat);
+    std::memcpy(out + 14, "MTrk", 4);
+    putU32(out + 18, static_cast<std::uint32_t>(p - out - HEADER_SIZE));
+    return static_cast<std::size_t>(p - out);
+}
+
+MidiWriter::MidiWriter(const MidiRenderOptions& options)
+    : m_options(options)
+{
+}
+
+std::size_t MidiWriter::render(const ChordProgression& progression, const std::vector<double>& durations) {
+    const std::size_t bound = midiSizeBound(progression, m_options);
+    if (m_buffer.size() < bound) {
+        m_buffer.resize(bound);
+    }
+    m_size = 0;
+    m_size = encodeMidi(progression, durations, m_options, m_buffer.data(), m_buffer.size());
+    return m_size;
+}
+
+const std::uint8_t* MidiWriter::data() const {
+    return m_buffer.data();
+}
+
+std::size_t MidiWriter::size() const {
+    return m_size;
+}
+
+const MidiRenderOptions& MidiWriter::options() const {
+    return m_options;
+}
+
+void MidiWriter::writeFile(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path + " for writing.");
+    }
+    // Unbuffered: the whole file goes to the OS in one write
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    const bool ok = std::fwrite(m_buffer.data(), 1, m_size, file) == m_size;
+    if (std::fclose(file) != 0 || !ok) {
+        throw std::runtime_error("Failed to write " + path + ".");
+    }
+}
+
+// Contiguous ranges of files per task, so each task reuses one writer
+template <class Fn>
+static void forEachChunk(std::size_t count, unsigned threads, Fn&& fn) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t chunks = std::min<std::size_t>(count, std::size_t(threads) * 4);
+    parallelFor(chunks, threads, [&](std::size_t c) {
+        fn(count * c / chunks, count * (c + 1) / chunks);
+    });
+}
+
+MidiBatch renderMidiBatch(const std::vector<ChordProgression>& progressions,
+                          const std::vector<std::vector<double>>& durations,
+                          const MidiRenderOptions& options,
+                          unsigned threads)
+{
+    if (progressions.size() != durations.size()) {
+        throw std::runtime_error("renderMidiBatch needs durations for every progression.");
+    }
+    const std::size_t count = progressions.size();
+
+    // Encode every file into its bound-sized slot, then close the gaps
+    std::vector<std::size_t> slots(count + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        slots[i + 1] = slots[i] + midiSizeBound(progressions[i], options);
+    }
+    MidiBatch batch;
+    batch.bytes.resize(slots[count]);
+    std::vector<std::size_t> sizes(count);
+    forEachChunk(count, threads, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            sizes[i] = encodeMidi(progressions[i], durations[i], options,
+                                  batch.bytes.data() + slots[i], slots[i + 1] - slots[i]);
+        }
+    });
+
+    batch.offsets.resize(count + 1);
+    batch.offsets[0] = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (batch.offsets[i] != slots[i]) {
+            std::memmove(batch.bytes.data() + batch.offsets[i], batch.bytes.data() + slots[i], sizes[i]);
+        }
+        batch.offsets[i + 1] = batch.offsets[i] + sizes[i];
+    }
+    batch.bytes.resize(batch.offsets[count]);
+    return batch;
+}
+
+void writeMidiFiles(const std::vector<ChordProgression>& progressions,
+                    const std::vector<std::vector<double>>& durations,
+                    const std::vector<std::string>& paths,
+                    const MidiRenderOptions& options,
+                    unsigned threads)
+{
+    if (progressions.size() != durations.size() || progressions.size() != paths.size()) {
+        throw std::runtime_error("writeMidiFiles needs durations and a path for every progression.");
+    }
+    forEachChunk(progressions.size(), threads, [&](std::size_t first, std::size_t last) {
+        MidiWriter writer(options);
+        for (std::size_t i = first; i < last; ++i) {
+            writer.render(progressions[i], durations[i]);
+            writer.writeFile(paths[i]);
+        }
+    });
+}
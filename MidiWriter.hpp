@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * Standard MIDI File (format 0) rendering of chord progressions.
+ *
+ * Events are encoded straight into a caller-provided or reused byte buffer:
+ * variable-length delta times, running status throughout (note-offs are
+ * note-ons with velocity 0) and no allocation per chord or per event.
+ * Chord i lasts durations[i] beats; a single duration applies to every chord.
+ */
+
+enum class MidiVoicing {
+    Root,    // Chord::pitches() as is: root position in rootOctave
+    Close,   // every tone folded into the octave above the root
+    Drop2    // Close, with the second-highest tone dropped an octave
+};
+
+struct MidiRenderOptions {
+    MidiVoicing voicing = MidiVoicing::Root;
+    int rootOctave = 4;                 // C4 = 60
+    bool addBass = false;               // also play the bass (slash note or root) below the voicing
+    std::uint16_t ticksPerBeat = 480;
+    std::uint32_t tempo = 500000;       // microseconds per beat (120 bpm)
+    std::uint8_t channel = 0;
+    std::uint8_t velocity = 90;
+    int program = -1;                   // General MIDI program, -1 for none
+};
+
+// Upper bound on the encoded size, for sizing buffers
+std::size_t midiSizeBound(const ChordProgression& progression, const MidiRenderOptions& options);
+
+/**
+ * Encode a whole file into 'out', which must hold midiSizeBound() bytes.
+ * Returns the number of bytes written; throws std::runtime_error if
+ * 'capacity' is smaller or the durations do not match the progression.
+ */
+std::size_t encodeMidi(const ChordProgression& progression, const std::vector<double>& durations,
+                       const MidiRenderOptions& options, std::uint8_t* out, std::size_t capacity);
+
+/**
+ * Encoder with a buffer that grows to the largest file seen and is then
+ * reused, so rendering many files in a row allocates nothing.
+ */
+class MidiWriter {
+public:
+    explicit MidiWriter(const MidiRenderOptions& options = MidiRenderOptions());
+
+    // Encode; the bytes stay valid until the next render()
+    std::size_t render(const ChordProgression& progression, const std::vector<double>& durations);
+    const std::uint8_t* data() const;
+    std::size_t size() const;
+
+    // Write the last rendered file with a single unbuffered write
+    void writeFile(const std::string& path) const;
+
+    const MidiRenderOptions& options() const;
+
+private:
+    MidiRenderOptions m_options;
+    std::vector<std::uint8_t> m_buffer;
+    std::size_t m_size = 0;
+};
+
+// Many files in one contiguous buffer: file i is bytes[offsets[i], offsets[i+1])
+struct MidiBatch {
+    std::vector<std::uint8_t> bytes;
+    std::vector<std::size_t> offsets;
+};
+
+/**
+ * Render many progressions in parallel ('threads' workers, 0 = hardware
+ * concurrency). durations[i] belongs to progressions[i].
+ */
+MidiBatch renderMidiBatch(const std::vector<ChordProgression>& progressions,
+                          const std::vector<std::vector<double>>& durations,
+                          const MidiRenderOptions& options = MidiRenderOptions(),
+                          unsigned threads = 0);
+
+// Render and write progressions[i] to paths[i], in parallel
+void writeMidiFiles(const std::vector<ChordProgression>& progressions,
+                    const std::vector<std::vector<double>>& durations,
+                    const std::vector<std::string>& paths,
+                    const MidiRenderOptions& options = MidiRenderOptions(),
+                    unsigned threads = 0);
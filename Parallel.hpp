@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/**
+ * Minimal work-sharing loop used by the batch APIs: calls fn(i) for every
+ * i in [0, count) on up to 'threads' workers (0 = hardware concurrency).
+ * The first exception thrown by a worker is rethrown on the calling thread.
+ */
+template <class Fn>
+void parallelFor(std::size_t count, unsigned threads, Fn&& fn) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+    if (threads <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::vector<std::exception_ptr> errors(threads);
+    auto worker = [&](unsigned id) {
+        try {
+            for (std::size_t i = next++; i < count; i = next++) {
+                fn(i);
+            }
+        } catch (...) {
+            errors[id] = std::current_exception();
+            next = count; // stop the others early
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned id = 0; id < threads; ++id) {
+        pool.emplace_back(worker, id);
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
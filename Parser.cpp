@@ -1,5 +1,7 @@
 #include "Parser.hpp"
 #include "Constants.hpp"
+#include "QualityManager.hpp"
+#include "Metrics.hpp"
 #include <stdexcept>
 #include <regex>
 
@@ -15,6 +17,7 @@ static void checkNote(const std::string& note) {
  * chord portion. Also check if there's an inversion number like "/9".
  */
 ChordTokens parseChord(const std::string& chordExpression) {
+    CYCHORD_METRIC_TIMER(Metric::ParseChord);
     ChordTokens tokens;
     tokens.inversion = 0;
 
@@ -64,3 +67,11 @@ ChordTokens parseChord(const std::string& chordExpression) {
 
     return tokens;
 }
+
+ChordTokens parseChord(const std::string& chordExpression, const QualityManager& qualities) {
+    ChordTokens tokens = parseChord(chordExpression);
+    if (!qualities.hasQuality(tokens.qualityName)) {
+        throw std::runtime_error("Unknown quality: " + tokens.qualityName);
+    }
+    return tokens;
+}
@@ -19,3 +19,11 @@ struct ChordTokens {
  * Parse a chord name into tokens: root, quality, appended, slash, etc.
  */
 ChordTokens parseChord(const std::string& chordExpression);
+
+class QualityManager;
+
+/**
+ * Same, but also checks that the quality is known to 'qualities'
+ * (throws std::runtime_error otherwise).
+ */
+ChordTokens parseChord(const std::string& chordExpression, const QualityManager& qualities);
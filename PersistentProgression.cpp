@@ -0,0 +1,264 @@
+#include "PersistentProgression.hpp"
+#include <stdexcept>
+#include <sstream>
+
+struct PersistentProgression::Node {
+    Chord value;
+    std::uint32_t priority;
+    std::size_t size;
+    NodePtr left;
+    NodePtr right;
+
+    Node(const Chord& v, std::uint32_t p, NodePtr l, NodePtr r)
+        : value(v),
+          priority(p),
+          size(1 + sizeOf(l) + sizeOf(r)),
+          left(std::move(l)),
+          right(std::move(r))
+    {
+    }
+};
+
+// Treap priorities; any well-mixed sequence will do
+static std::uint32_t randomPriority() {
+    thread_local std::uint32_t state = 0x9E3779B9u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+PersistentProgression::PersistentProgression() {}
+
+PersistentProgression::PersistentProgression(NodePtr root)
+    : m_root(std::move(root))
+{
+}
+
+PersistentProgression::PersistentProgression(const ChordProgression& progression)
+    : m_root(build(progression.chords().data(), progression.size()))
+{
+}
+
+PersistentProgression::PersistentProgression(const std::vector<Chord>& chords)
+    : m_root(build(chords.data(), chords.size()))
+{
+}
+
+std::size_t PersistentProgression::sizeOf(const NodePtr& node) {
+    return node ? node->size : 0;
+}
+
+PersistentProgression::NodePtr PersistentProgression::makeNode(const Chord& value, std::uint32_t priority,
+                                                               NodePtr left, NodePtr right) {
+    return std::make_shared<const Node>(value, priority, std::move(left), std::move(right));
+}
+
+/**
+ * Join two treaps (all of 'a' before all of 'b'). Only nodes on the right
+ * spine of 'a' and the left spine of 'b' are copied.
+ */
+PersistentProgression::NodePtr PersistentProgression::merge(const NodePtr& a, const NodePtr& b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (a->priority >= b->priority) {
+        return makeNode(a->value, a->priority, a->left, merge(a->right, b));
+    }
+    return makeNode(b->value, b->priority, merge(a, b->left), b->right);
+}
+
+/**
+ * Split into the first 'count' chords and the rest, copying only the search path.
+ */
+void PersistentProgression::split(const NodePtr& node, std::size_t count, NodePtr& left, NodePtr& right) {
+    if (!node) {
+        left = nullptr;
+        right = nullptr;
+        return;
+    }
+    std::size_t leftSize = sizeOf(node->left);
+    if (count <= leftSize) {
+        NodePtr l, r;
+        split(node->left, count, l, r);
+        left = l;
+        right = makeNode(node->value, node->priority, r, node->right);
+    } else {
+        NodePtr l, r;
+        split(node->right, count - leftSize - 1, l, r);
+        left = makeNode(node->value, node->priority, node->left, l);
+        right = r;
+    }
+}
+
+/**
+ * O(n) bulk load: a Cartesian tree over random priorities, built bottom-up
+ * so that no node is ever modified after it has been shared.
+ */
+PersistentProgression::NodePtr PersistentProgression::build(const Chord* chords, std::size_t count) {
+    if (count == 0) {
+        return nullptr;
+    }
+    // First find the tree shape with plain indices...
+    std::vector<std::uint32_t> priority(count);
+    std::vector<long> left(count, -1), right(count, -1);
+    std::vector<long> stack;
+    for (std::size_t i = 0; i < count; ++i) {
+        priority[i] = randomPriority();
+        long last = -1;
+        while (!stack.empty() && priority[stack.back()] < priority[i]) {
+            last = stack.back();
+            stack.pop_back();
+        }
+        left[i] = last;
+        if (!stack.empty()) {
+            right[stack.back()] = static_cast<long>(i);
+        }
+        stack.push_back(static_cast<long>(i));
+    }
+
+    // ...then create the immutable nodes children-first (post-order)
+    std::vector<NodePtr> nodes(count);
+    std::vector<std::pair<long, bool>> work;
+    work.emplace_back(stack.front(), false);
+    while (!work.empty()) {
+        auto item = work.back();
+        work.pop_back();
+        long i = item.first;
+        if (item.second) {
+            nodes[i] = makeNode(chords[i], priority[i],
+                                left[i] >= 0 ? nodes[left[i]] : nullptr,
+                                right[i] >= 0 ? nodes[right[i]] : nullptr);
+            continue;
+        }
+        work.emplace_back(i, true);
+        if (left[i] >= 0) work.emplace_back(left[i], false);
+        if (right[i] >= 0) work.emplace_back(right[i], false);
+    }
+    return nodes[stack.front()];
+}
+
+template <class Fn>
+void PersistentProgression::forEach(const NodePtr& node, Fn&& fn) {
+    // in-order walk; depth is O(log n) in expectation
+    if (!node) return;
+    forEach(node->left, fn);
+    fn(node->value);
+    forEach(node->right, fn);
+}
+
+ChordProgression PersistentProgression::toProgression() const {
+    return ChordProgression(toVector());
+}
+
+std::vector<Chord> PersistentProgression::toVector() const {
+    std::vector<Chord> result;
+    result.reserve(size());
+    forEach(m_root, [&](const Chord& c) { result.push_back(c); });
+    return result;
+}
+
+PersistentProgression PersistentProgression::snapshot() const {
+    return *this;
+}
+
+std::size_t PersistentProgression::size() const {
+    return sizeOf(m_root);
+}
+
+bool PersistentProgression::empty() const {
+    return !m_root;
+}
+
+const Chord& PersistentProgression::operator[](std::size_t index) const {
+    if (index >= size()) {
+        throw std::runtime_error("Index out of range in PersistentProgression::operator[]");
+    }
+    const Node* node = m_root.get();
+    while (true) {
+        std::size_t leftSize = sizeOf(node->left);
+        if (index < leftSize) {
+            node = node->left.get();
+        } else if (index == leftSize) {
+            return node->value;
+        } else {
+            index -= leftSize + 1;
+            node = node->right.get();
+        }
+    }
+}
+
+void PersistentProgression::append(const Chord& chord) {
+    m_root = merge(m_root, makeNode(chord, randomPriority(), nullptr, nullptr));
+}
+
+void PersistentProgression::insert(std::size_t index, const Chord& chord) {
+    if (index > size()) {
+        throw std::runtime_error("Index out of range in PersistentProgression::insert.");
+    }
+    NodePtr left, right;
+    split(m_root, index, left, right);
+    m_root = merge(merge(left, makeNode(chord, randomPriority(), nullptr, nullptr)), right);
+}
+
+Chord PersistentProgression::pop(std::size_t index) {
+    if (!m_root) {
+        throw std::runtime_error("Cannot pop from empty PersistentProgression.");
+    }
+    if (index == static_cast<std::size_t>(-1)) {
+        index = size() - 1; // last
+    }
+    if (index >= size()) {
+        throw std::runtime_error("Index out of range in PersistentProgression::pop.");
+    }
+    NodePtr left, middle, right;
+    split(m_root, index, left, right);
+    split(right, 1, middle, right);
+    Chord removed = middle->value;
+    m_root = merge(left, right);
+    return removed;
+}
+
+void PersistentProgression::set(std::size_t index, const Chord& chord) {
+    if (index >= size()) {
+        throw std::runtime_error("Index out of range in PersistentProgression::set.");
+    }
+    NodePtr left, middle, right;
+    split(m_root, index, left, right);
+    split(right, 1, middle, right);
+    m_root = merge(merge(left, makeNode(chord, middle->priority, nullptr, nullptr)), right);
+}
+
+PersistentProgression& PersistentProgression::operator+=(const PersistentProgression& other) {
+    m_root = merge(m_root, other.m_root);
+    return *this;
+}
+
+void PersistentProgression::transpose(int semitones) {
+    if (semitones == 0) return;
+    std::vector<Chord> chords = toVector();
+    for (auto& c : chords) {
+        c.transpose(semitones);
+    }
+    m_root = build(chords.data(), chords.size());
+}
+
+bool PersistentProgression::operator==(const PersistentProgression& other) const {
+    if (m_root == other.m_root) {
+        return true; // same version
+    }
+    if (size() != other.size()) {
+        return false;
+    }
+    return toVector() == other.toVector();
+}
+
+std::string PersistentProgression::toString() const {
+    std::ostringstream oss;
+    bool first = true;
+    forEach(m_root, [&](const Chord& c) {
+        if (!first) oss << " | ";
+        oss << c.chordNameView();
+        first = false;
+    });
+    return oss.str();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * A persistent (immutable, structurally shared) progression of Chords.
+ *
+ * Backed by an implicit treap: insert, erase, set and concatenation copy only
+ * the O(log n) nodes on the touched path, and every other node is shared with
+ * earlier versions. Copying a PersistentProgression is therefore an O(1)
+ * snapshot, which makes undo stacks cheap.
+ */
+
+class PersistentProgression {
+public:
+    PersistentProgression(); // empty
+    explicit PersistentProgression(const ChordProgression& progression);
+    explicit PersistentProgression(const std::vector<Chord>& chords);
+
+    // Convert back to the plain, vector-backed class
+    ChordProgression toProgression() const;
+    std::vector<Chord> toVector() const;
+
+    // O(1): another handle on the same version
+    PersistentProgression snapshot() const;
+
+    std::size_t size() const;
+    bool empty() const;
+
+    // O(log n) access and edits
+    const Chord& operator[](std::size_t index) const;
+    void append(const Chord& chord);
+    void insert(std::size_t index, const Chord& chord);
+    Chord pop(std::size_t index = static_cast<std::size_t>(-1));
+    void set(std::size_t index, const Chord& chord);
+
+    // O(log n) concatenation
+    PersistentProgression& operator+=(const PersistentProgression& other);
+
+    // O(n): every chord changes
+    void transpose(int semitones);
+
+    bool operator==(const PersistentProgression& other) const;
+    bool operator!=(const PersistentProgression& other) const { return !(*this == other); }
+
+    // Info
+    std::string toString() const;
+
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    NodePtr m_root;
+
+    explicit PersistentProgression(NodePtr root);
+
+    static std::size_t sizeOf(const NodePtr& node);
+    static NodePtr makeNode(const Chord& value, std::uint32_t priority, NodePtr left, NodePtr right);
+    static NodePtr merge(const NodePtr& a, const NodePtr& b);
+    static void split(const NodePtr& node, std::size_t count, NodePtr& left, NodePtr& right);
+    static NodePtr build(const Chord* chords, std::size_t count);
+    template <class Fn>
+    static void forEach(const NodePtr& node, Fn&& fn);
+};
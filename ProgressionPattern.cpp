@@ -0,0 +1,532 @@
+#include "ProgressionPattern.hpp"
+#include "Parallel.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+static const char* CLASS_NAMES[] = {"maj", "min", "dom", "dim", "hdim", "aug", "sus"};
+static const int CLASS_COUNT = 7;
+static const int MAX_REPEAT = 32;
+
+// Quality classes over the root-relative pitch-class mask
+static bool inClass(int qualityClass, unsigned mask) {
+    auto has = [&](int i) { return ((mask >> i) & 1u) != 0; };
+    switch (qualityClass) {
+    case 0: return has(4) && has(7) && !has(3) && !has(10);     // maj, 6, maj7, add9
+    case 1: return has(3) && has(7) && !has(4);                 // m, m7, m6, mM7
+    case 2: return has(4) && has(10);                           // 7, 9, 13, 7#9, 7b5
+    case 3: return has(3) && has(6) && !has(7) && !has(10);     // dim, dim7
+    case 4: return has(3) && has(6) && has(10);                 // m7b5
+    case 5: return has(4) && has(8) && !has(7);                 // aug, 7#5
+    case 6: return !has(3) && !has(4) && (has(5) || has(2));    // sus2, sus4, 7sus4
+    default: return true;
+    }
+}
+
+bool ProgressionPatterns::Atom::operator==(const Atom& other) const {
+    return root == other.root && motion == other.motion &&
+           qualityClass == other.qualityClass && quality == other.quality;
+}
+
+/**
+ * Recursive-descent parser to a small AST, then Thompson construction.
+ * Repetition counts copy the sub-automaton, so {n,m} is capped.
+ */
+class ProgressionPatterns::Compiler {
+public:
+    Compiler(ProgressionPatterns& set, const std::string& text, std::size_t index)
+        : m_set(set), m_text(text), m_index(index)
+    {
+    }
+
+    // Returns the pattern's start state; its accepting state is 'matchState'
+    int compile(int matchState) {
+        const int root = parseAlternation();
+        skipSpace();
+        if (m_pos != m_text.size()) fail("unexpected '" + std::string(1, m_text[m_pos]) + "'");
+        if (m_nodes[root].kind == Node::Empty) fail("empty pattern");
+        const Fragment f = emit(root);
+        m_set.m_states[f.end].out.push_back(matchState);
+        return f.start;
+    }
+
+private:
+    struct Node {
+        enum Kind { Empty, AtomNode, Concat, Alternate, Repeat } kind;
+        explicit Node(Kind k) : kind(k) {}
+        int atom = -1;
+        std::vector<int> children;
+        int min = 0, max = 0;   // Repeat; max -1 = unbounded
+    };
+    struct Fragment {
+        int start, end;   // 'end' is an epsilon state with no exits yet
+    };
+
+    ProgressionPatterns& m_set;
+    const std::string& m_text;
+    std::size_t m_index;
+    std::size_t m_pos = 0;
+    std::vector<Node> m_nodes;
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Pattern " + std::to_string(m_index) + " at " +
+                                 std::to_string(m_pos) + ": " + what + " in \"" + m_text + "\"");
+    }
+
+    void skipSpace() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+    }
+
+    int node(Node n) {
+        m_nodes.push_back(std::move(n));
+        return static_cast<int>(m_nodes.size()) - 1;
+    }
+
+    int parseAlternation() {
+        Node alt(Node::Alternate);
+        alt.children.push_back(parseSequence());
+        skipSpace();
+        while (m_pos < m_text.size() && m_text[m_pos] == '|') {
+            ++m_pos;
+            alt.children.push_back(parseSequence());
+            skipSpace();
+        }
+        return alt.children.size() == 1 ? alt.children[0] : node(std::move(alt));
+    }
+
+    int parseSequence() {
+        Node seq(Node::Concat);
+        for (;;) {
+            skipSpace();
+            if (m_pos == m_text.size() || m_text[m_pos] == '|' || m_text[m_pos] == ')') break;
+            seq.children.push_back(parseQuantified());
+        }
+        if (seq.children.empty()) return node(Node(Node::Empty));
+        return seq.children.size() == 1 ? seq.children[0] : node(std::move(seq));
+    }
+
+    int parseQuantified() {
+        int item;
+        if (m_text[m_pos] == '(') {
+            ++m_pos;
+            item = parseAlternation();
+            skipSpace();
+            if (m_pos == m_text.size() || m_text[m_pos] != ')') fail("missing ')'");
+            ++m_pos;
+        } else {
+            item = parseChordSpec();
+        }
+        // Quantifiers follow without a space, so "+5dom" after a space is motion
+        while (m_pos < m_text.size()) {
+            Node rep(Node::Repeat);
+            rep.children.push_back(item);
+            const char c = m_text[m_pos];
+            if (c == '*') { rep.min = 0; rep.max = -1; ++m_pos; }
+            else if (c == '+') { rep.min = 1; rep.max = -1; ++m_pos; }
+            else if (c == '?') { rep.min = 0; rep.max = 1; ++m_pos; }
+            else if (c == '{') { ++m_pos; parseCounts(rep.min, rep.max); }
+            else break;
+            item = node(std::move(rep));
+        }
+        return item;
+    }
+
+    int parseNumber() {
+        if (m_pos == m_text.size() || !std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) {
+            fail("expected a number");
+        }
+        int n = 0;
+        while (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) {
+            n = n * 10 + (m_text[m_pos++] - '0');
+            if (n > 1000) fail("number too large");
+        }
+        return n;
+    }
+
+    void parseCounts(int& min, int& max) {
+        min = parseNumber();
+        max = min;
+        if (m_pos < m_text.size() && m_text[m_pos] == ',') {
+            ++m_pos;
+            max = (m_pos < m_text.size() && m_text[m_pos] == '}') ? -1 : parseNumber();
+        }
+        if (m_pos == m_text.size() || m_text[m_pos] != '}') fail("missing '}'");
+        ++m_pos;
+        if ((max >= 0 && max < min) || min > MAX_REPEAT || max > MAX_REPEAT) {
+            fail("bad repetition count (at most " + std::to_string(MAX_REPEAT) + ")");
+        }
+    }
+
+    int parseInterval() {
+        static const char* NAMES[] = {"P1", "m2", "M2", "m3", "M3", "P4", "TT", "P5", "m6", "M6", "m7", "M7", "P8"};
+        if (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) {
+            return parseNumber() % 12;
+        }
+        for (int i = 0; i < 13; ++i) {
+            if (m_text.compare(m_pos, 2, NAMES[i]) == 0) {
+                m_pos += 2;
+                return i % 12;
+            }
+        }
+        fail("expected an interval (semitones or P4, m3, TT, ...)");
+    }
+
+    int parseChordSpec() {
+        Atom atom;   // '.' and "any" leave every field open
+        const std::size_t begin = m_pos;
+        const char c = m_text[m_pos];
+        if (c == '+' || c == '-') {
+            ++m_pos;
+            const int semitones = parseInterval();
+            atom.motion = c == '+' ? semitones : (12 - semitones) % 12;
+        } else if (c >= 'A' && c <= 'G') {
+            std::size_t len = 1;
+            if (m_pos + 1 < m_text.size() && (m_text[m_pos + 1] == '#' || m_text[m_pos + 1] == 'b')) len = 2;
+            try {
+                atom.root = noteToVal(std::string_view(m_text).substr(m_pos, len));
+            } catch (const std::runtime_error&) {
+                fail("unknown note");
+            }
+            m_pos += len;
+        }
+
+        if (m_pos < m_text.size() && m_text[m_pos] == '"') {
+            const std::size_t close = m_text.find('"', m_pos + 1);
+            if (close == std::string::npos) fail("missing '\"'");
+            atom.quality = m_text.substr(m_pos + 1, close - m_pos - 1);
+            m_pos = close + 1;
+        } else if (m_pos < m_text.size() && m_text[m_pos] == '.') {
+            ++m_pos;
+        } else if (m_pos < m_text.size() && std::islower(static_cast<unsigned char>(m_text[m_pos]))) {
+            std::size_t end = m_pos;
+            while (end < m_text.size() && std::islower(static_cast<unsigned char>(m_text[end]))) ++end;
+            const std::string word = m_text.substr(m_pos, end - m_pos);
+            if (word != "any") {
+                for (int i = 0; i < CLASS_COUNT; ++i) {
+                    if (word == CLASS_NAMES[i]) atom.qualityClass = i;
+                }
+                if (atom.qualityClass < 0) fail("unknown chord class '" + word + "'");
+            }
+            m_pos = end;
+        }
+        if (m_pos == begin) fail("expected a chord");
+
+        Node n(Node::AtomNode);
+        n.atom = m_set.addAtom(atom);
+        return node(std::move(n));
+    }
+
+    int state(int atom = -1) {
+        m_set.m_states.push_back(State());
+        m_set.m_states.back().atom = atom;
+        return static_cast<int>(m_set.m_states.size()) - 1;
+    }
+
+    void link(int from, int to) {
+        m_set.m_states[from].out.push_back(to);
+    }
+
+    Fragment emit(int index) {
+        const Node n = m_nodes[index];
+        switch (n.kind) {
+        case Node::Empty: {
+            const int s = state();
+            return Fragment{s, s};
+        }
+        case Node::AtomNode: {
+            const int s = state(n.atom);
+            const int e = state();
+            link(s, e);
+            return Fragment{s, e};
+        }
+        case Node::Concat: {
+            Fragment f = emit(n.children[0]);
+            for (std::size_t i = 1; i < n.children.size(); ++i) {
+                const Fragment next = emit(n.children[i]);
+                link(f.end, next.start);
+                f.end = next.end;
+            }
+            return f;
+        }
+        case Node::Alternate: {
+            const int s = state();
+            const int e = state();
+            for (int child : n.children) {
+                const Fragment f = emit(child);
+                link(s, f.start);
+                link(f.end, e);
+            }
+            return Fragment{s, e};
+        }
+        case Node::Repeat: {
+            // min mandatory copies, then optional ones or a loop
+            const int s = state();
+            int end = s;
+            for (int i = 0; i < n.min; ++i) {
+                const Fragment f = emit(n.children[0]);
+                link(end, f.start);
+                end = f.end;
+            }
+            const int e = state();
+            if (n.max < 0) {
+                const Fragment f = emit(n.children[0]);
+                link(end, f.start);
+                link(end, e);
+                link(f.end, f.start);
+                link(f.end, e);
+            } else {
+                for (int i = n.min; i < n.max; ++i) {
+                    const Fragment f = emit(n.children[0]);
+                    link(end, f.start);
+                    link(end, e);
+                    end = f.end;
+                }
+                link(end, e);
+            }
+            return Fragment{s, e};
+        }
+        }
+        fail("internal error");
+    }
+};
+
+ProgressionPatterns::ProgressionPatterns(const std::vector<std::string>& patterns)
+    : m_patterns(patterns)
+{
+    m_states.push_back(State());   // m_start
+    m_start = 0;
+    for (std::size_t p = 0; p < patterns.size(); ++p) {
+        m_states.push_back(State());
+        const int matchState = static_cast<int>(m_states.size()) - 1;
+        m_states[matchState].match = static_cast<int>(p);
+        Compiler compiler(*this, patterns[p], p);
+        const int start = compiler.compile(matchState);
+        m_states[m_start].out.push_back(start);
+    }
+}
+
+int ProgressionPatterns::addAtom(const Atom& atom) {
+    for (std::size_t i = 0; i < m_atoms.size(); ++i) {
+        if (m_atoms[i] == atom) return static_cast<int>(i);
+    }
+    if (m_atoms.size() == 64) {
+        throw std::runtime_error("Pattern set uses more than 64 distinct chord specs.");
+    }
+    m_atoms.push_back(atom);
+    return static_cast<int>(m_atoms.size()) - 1;
+}
+
+std::size_t ProgressionPatterns::size() const {
+    return m_patterns.size();
+}
+
+const std::string& ProgressionPatterns::pattern(std::size_t index) const {
+    return m_patterns.at(index);
+}
+
+std::uint64_t ProgressionPatterns::atomBits(const Chord& chord, const Chord* previous) const {
+    const int root = noteToVal(chord.rootView());
+    const unsigned absolute = chord.pitchClassMask();
+    const unsigned mask = ((absolute >> root) | (absolute << (12 - root))) & 0xFFFu;
+    const int motion = previous ? (root - noteToVal(previous->rootView()) + 12) % 12 : -1;
+    unsigned classes = 0;
+    for (int c = 0; c < CLASS_COUNT; ++c) {
+        if (inClass(c, mask)) classes |= 1u << c;
+    }
+
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < m_atoms.size(); ++i) {
+        const Atom& a = m_atoms[i];
+        if (a.root >= 0 && a.root != root) continue;
+        if (a.motion >= 0 && a.motion != motion) continue;
+        if (a.qualityClass >= 0 && !((classes >> a.qualityClass) & 1u)) continue;
+        if (!a.quality.empty() && a.quality != chord.quality()->getQualityName()) continue;
+        bits |= std::uint64_t(1) << i;
+    }
+    return bits;
+}
+
+std::vector<PatternMatch> ProgressionPatterns::scan(const ChordProgression& progression) const {
+    PatternScanner scanner(*this);
+    std::vector<PatternMatch> matches;
+    scanner.scan(progression, 0, matches);
+    return matches;
+}
+
+std::vector<PatternMatch> ProgressionPatterns::scan(const std::vector<ChordProgression>& corpus,
+                                                    unsigned threads) const {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Contiguous chunks, one scanner (and DFA cache) each; merged in corpus order
+    const std::size_t chunks = std::min<std::size_t>(corpus.size(), std::size_t(threads) * 4);
+    std::vector<std::vector<PatternMatch>> results(chunks);
+    parallelFor(chunks, threads, [&](std::size_t c) {
+        PatternScanner scanner(*this);
+        for (std::size_t i = corpus.size() * c / chunks; i < corpus.size() * (c + 1) / chunks; ++i) {
+            scanner.scan(corpus[i], i, results[c]);
+        }
+    });
+    std::vector<PatternMatch> matches;
+    for (auto& part : results) {
+        matches.insert(matches.end(), part.begin(), part.end());
+    }
+    return matches;
+}
+
+std::size_t PatternScanner::VectorHash::operator()(const std::vector<int>& v) const {
+    std::size_t h = 1469598103934665603ull;
+    for (int x : v) {
+        h = (h ^ static_cast<std::size_t>(x)) * 1099511628211ull;
+    }
+    return h;
+}
+
+PatternScanner::PatternScanner(const ProgressionPatterns& patterns, std::size_t maxDfaStates)
+    : m_patterns(patterns), m_maxStates(std::max<std::size_t>(maxDfaStates, 16)),
+      m_mark(patterns.m_states.size(), 0), m_added(patterns.m_states.size(), 0),
+      m_matchBegin(patterns.size(), 0)
+{
+    m_startStates.push_back(patterns.m_start);
+    closure(m_startStates, false);
+}
+
+std::size_t PatternScanner::dfaStates() const {
+    return m_dfa.size();
+}
+
+// Epsilon closure, keeping consuming states (and accepting ones if asked); sorted
+void PatternScanner::closure(std::vector<int>& states, bool keepMatches) {
+    const auto& nfa = m_patterns.m_states;
+    m_stack.assign(states.begin(), states.end());
+    states.clear();
+    m_visited.clear();
+    while (!m_stack.empty()) {
+        const int s = m_stack.back();
+        m_stack.pop_back();
+        if (m_mark[s]) continue;
+        m_mark[s] = 1;
+        m_visited.push_back(s);
+        if (nfa[s].atom >= 0 || (nfa[s].match >= 0 && keepMatches)) {
+            states.push_back(s);
+        } else {
+            for (int to : nfa[s].out) m_stack.push_back(to);
+        }
+    }
+    for (int s : m_visited) m_mark[s] = 0;
+    std::sort(states.begin(), states.end());
+}
+
+int PatternScanner::dfaStateFor(std::vector<int>& nfaStates) {
+    auto it = m_index.find(nfaStates);
+    if (it != m_index.end()) return it->second;
+    DfaState state;
+    for (int s : nfaStates) {
+        if (m_patterns.m_states[s].match >= 0) state.matches.push_back(m_patterns.m_states[s].match);
+    }
+    std::sort(state.matches.begin(), state.matches.end());
+    state.nfaStates = nfaStates;
+    m_dfa.push_back(std::move(state));
+    const int id = static_cast<int>(m_dfa.size()) - 1;
+    m_index.emplace(nfaStates, id);
+    return id;
+}
+
+int PatternScanner::step(int state, std::uint64_t symbol) {
+    auto cached = m_dfa[state].next.find(symbol);
+    if (cached != m_dfa[state].next.end()) return cached->second;
+
+    const auto& nfa = m_patterns.m_states;
+    std::vector<int> next;
+    for (int s : m_dfa[state].nfaStates) {
+        if (nfa[s].atom >= 0 && ((symbol >> nfa[s].atom) & 1u)) next.push_back(nfa[s].out[0]);
+    }
+    closure(next, true);
+    // Unanchored: a new match may start at every chord. Accepting states reached
+    // without consuming are left out, so empty matches are never reported.
+    next.insert(next.end(), m_startStates.begin(), m_startStates.end());
+    std::sort(next.begin(), next.end());
+    next.erase(std::unique(next.begin(), next.end()), next.end());
+    const int id = dfaStateFor(next);
+    m_dfa[state].next.emplace(symbol, id);
+    return id;
+}
+
+// Add a thread and its epsilon closure; states already reached in this generation
+// belong to a thread with an earlier (or equal) start and are skipped
+void PatternScanner::addThread(int state, std::size_t begin, bool recordMatches,
+                               std::vector<int>& threads, std::vector<std::size_t>& starts) {
+    const auto& nfa = m_patterns.m_states;
+    m_stack.assign(1, state);
+    while (!m_stack.empty()) {
+        const int s = m_stack.back();
+        m_stack.pop_back();
+        if (m_added[s] == m_generation) continue;
+        m_added[s] = m_generation;
+        if (nfa[s].atom >= 0) {
+            threads.push_back(s);
+            starts.push_back(begin);
+            continue;
+        }
+        if (nfa[s].match >= 0 && recordMatches) {
+            m_matchBegin[nfa[s].match] = begin;
+            m_hits.push_back(nfa[s].match);
+        }
+        for (int to : nfa[s].out) m_stack.push_back(to);
+    }
+}
+
+// Leftmost-start NFA simulation over chords [0, last): each chord is visited once
+void PatternScanner::findStarts(std::size_t last, std::size_t index, std::vector<PatternMatch>& out) {
+    const auto& nfa = m_patterns.m_states;
+    m_threads.clear();
+    m_threadStarts.clear();
+    ++m_generation;
+    for (std::size_t i = 0; i < last; ++i) {
+        // A new match may start here; it has the latest start, so it goes last
+        addThread(m_patterns.m_start, i, false, m_threads, m_threadStarts);
+
+        ++m_generation;
+        m_nextThreads.clear();
+        m_nextThreadStarts.clear();
+        m_hits.clear();
+        for (std::size_t t = 0; t < m_threads.size(); ++t) {
+            const int s = m_threads[t];
+            if ((m_symbols[i] >> nfa[s].atom) & 1u) {
+                addThread(nfa[s].out[0], m_threadStarts[t], true, m_nextThreads, m_nextThreadStarts);
+            }
+        }
+        std::sort(m_hits.begin(), m_hits.end());
+        for (int pattern : m_hits) {
+            out.push_back(PatternMatch{static_cast<std::size_t>(pattern), index, m_matchBegin[pattern], i + 1});
+        }
+        m_threads.swap(m_nextThreads);
+        m_threadStarts.swap(m_nextThreadStarts);
+    }
+}
+
+void PatternScanner::scan(const ChordProgression& progression, std::size_t index,
+                          std::vector<PatternMatch>& out) {
+    const auto& chords = progression.chords();
+    m_symbols.resize(chords.size());
+    for (std::size_t i = 0; i < chords.size(); ++i) {
+        m_symbols[i] = m_patterns.atomBits(chords[i], i ? &chords[i - 1] : nullptr);
+    }
+
+    if (m_dfa.size() > m_maxStates) {
+        m_dfa.clear();
+        m_index.clear();
+    }
+    // The DFA finds where matches end; only progressions with hits pay for their starts
+    int state = dfaStateFor(m_startStates);
+    std::size_t last = 0;
+    for (std::size_t i = 0; i < chords.size(); ++i) {
+        state = step(state, m_symbols[i]);
+        if (!m_dfa[state].matches.empty()) last = i + 1;
+    }
+    if (last > 0) {
+        findStarts(last, index, out);
+    }
+}
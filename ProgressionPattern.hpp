@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * Regex-like queries over chord sequences. A pattern is a sequence of chord
+ * specs separated by spaces, with grouping, alternation and repetition:
+ *
+ *     min +P4dom +P4maj          ii-V-I anywhere (root up a fourth each time)
+ *     (+5dom)+ maj               a chain of dominants resolving to a major chord
+ *     C . (G|Gdom) "sus4"?       absolute roots, wildcards, optional chords
+ *
+ * A chord spec is [root or motion][class or "quality"], at least one part:
+ *   root     C, F#, Bb ...       absolute root
+ *   motion   +N / -N (semitones) or +P4, -M2, +TT, ... from the previous chord's root
+ *   class    maj min dom dim hdim aug sus, or '.' / any
+ *   quality  "m7", "7sus4" ...   exact quality name
+ * and may be followed by *, +, ?, {n} or {n,m} (no space before them);
+ * ( ... ) groups and | alternates.
+ *
+ * All patterns of a set compile into one Thompson NFA that a PatternScanner
+ * runs as a lazily built DFA: one pass per progression finds every pattern.
+ * Progressions with hits get a second linear pass over the NFA whose threads
+ * carry their start chord, giving every match its earliest start.
+ */
+
+struct PatternMatch {
+    std::size_t pattern;      // index into the pattern set
+    std::size_t progression;  // index into the scanned corpus
+    std::size_t begin;        // first chord
+    std::size_t end;          // one past the last chord
+};
+
+class ProgressionPatterns {
+public:
+    // Throws std::runtime_error naming the pattern and position on a syntax error
+    explicit ProgressionPatterns(const std::vector<std::string>& patterns);
+
+    std::size_t size() const;
+    const std::string& pattern(std::size_t index) const;
+
+    // Every match, ordered by end, then pattern
+    std::vector<PatternMatch> scan(const ChordProgression& progression) const;
+    // Whole corpus on 'threads' workers (0 = hardware concurrency), ordered by progression
+    std::vector<PatternMatch> scan(const std::vector<ChordProgression>& corpus, unsigned threads = 0) const;
+
+private:
+    friend class PatternScanner;
+
+    struct Atom {
+        int root = -1;         // absolute pitch class, -1 for any
+        int motion = -1;       // semitones up from the previous root, -1 for any
+        int qualityClass = -1; // index into the class tables, -1 for any
+        std::string quality;   // exact quality name, empty for any
+        bool operator==(const Atom& other) const;
+    };
+
+    // NFA state: consumes 'atom' then goes to out[0], or is an epsilon split, or accepts
+    struct State {
+        int atom = -1;          // -1: epsilon
+        int match = -1;         // pattern accepted here, -1 if none
+        std::vector<int> out;
+    };
+
+    std::vector<std::string> m_patterns;
+    std::vector<Atom> m_atoms;        // at most 64, shared between patterns
+    std::vector<State> m_states;
+    int m_start = 0;                  // split into every pattern's start
+
+    class Compiler;
+    int addAtom(const Atom& atom);
+    std::uint64_t atomBits(const Chord& chord, const Chord* previous) const;
+};
+
+/**
+ * Matching state for one thread: caches DFA states built while scanning, so
+ * keep one per worker and reuse it across progressions.
+ */
+class PatternScanner {
+public:
+    explicit PatternScanner(const ProgressionPatterns& patterns, std::size_t maxDfaStates = 4096);
+
+    // Appends the matches in 'progression' (tagged with 'index') to 'out'
+    void scan(const ChordProgression& progression, std::size_t index, std::vector<PatternMatch>& out);
+
+    std::size_t dfaStates() const;
+
+private:
+    struct DfaState {
+        std::vector<int> nfaStates;   // sorted epsilon closure
+        std::vector<int> matches;     // patterns accepted
+        std::unordered_map<std::uint64_t, int> next;
+    };
+    struct VectorHash {
+        std::size_t operator()(const std::vector<int>& v) const;
+    };
+
+    const ProgressionPatterns& m_patterns;
+    std::size_t m_maxStates;
+    std::vector<DfaState> m_dfa;
+    std::unordered_map<std::vector<int>, int, VectorHash> m_index;
+    std::vector<std::uint64_t> m_symbols;   // atom bits per chord, reused
+    std::vector<int> m_startStates;         // closure of the start, without accepting states
+    std::vector<char> m_mark;               // scratch for closures
+    std::vector<int> m_stack;
+    std::vector<int> m_visited;
+
+    // Leftmost-start pass: NFA threads (consuming states) with the chord they started at,
+    // kept in order of start so the first thread to reach a state has the earliest one
+    std::vector<int> m_threads;
+    std::vector<std::size_t> m_threadStarts;
+    std::vector<int> m_nextThreads;
+    std::vector<std::size_t> m_nextThreadStarts;
+    std::vector<std::size_t> m_added;       // generation in which each NFA state was last reached
+    std::size_t m_generation = 0;
+    std::vector<std::size_t> m_matchBegin;  // per pattern, earliest start of a match ending here
+    std::vector<int> m_hits;                // patterns matched at the current chord
+
+    int dfaStateFor(std::vector<int>& nfaStates);
+    int step(int state, std::uint64_t symbol);
+    void closure(std::vector<int>& states, bool keepMatches);
+    void addThread(int state, std::size_t begin, bool recordMatches,
+                   std::vector<int>& threads, std::vector<std::size_t>& starts);
+    void findStarts(std::size_t last, std::size_t index, std::vector<PatternMatch>& out);
+};
@@ -0,0 +1,191 @@
+#include "ProgressionStore.hpp"
+#include "Constants.hpp"
+#include "KeyAnalyzer.hpp"
+#include "Utils.hpp"
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+static const std::uint16_t UNKNOWN_QUALITY = 0xFFFF;
+
+ProgressionStore::ProgressionStore()
+    : m_songOffsets(1, 0)
+{
+}
+
+ProgressionStore ProgressionStore::build(const std::vector<ChordProgression>& songs, unsigned threads) {
+    ProgressionStore store;
+    std::unordered_map<std::string, std::uint16_t> ids;
+    for (const auto& entry : DEFAULT_QUALITIES) {
+        ids.emplace(entry.first, static_cast<std::uint16_t>(store.m_qualityNames.size()));
+        store.m_qualityNames.push_back(entry.first);
+    }
+
+    store.m_songOffsets.resize(songs.size() + 1);
+    for (std::size_t s = 0; s < songs.size(); ++s) {
+        store.m_songOffsets[s + 1] = store.m_songOffsets[s] + songs[s].size();
+    }
+    const std::size_t n = static_cast<std::size_t>(store.m_songOffsets.back());
+    store.m_roots.resize(n);
+    store.m_basses.resize(n);
+    store.m_qualities.resize(n);
+    store.m_masks.resize(n);
+
+    // Each task fills its songs' slots; names outside the table are resolved afterwards
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t chunks = std::min<std::size_t>(songs.size(), std::size_t(threads) * 4);
+    std::vector<std::vector<std::pair<std::uint64_t, std::string>>> unknown(chunks);
+    parallelFor(chunks, threads, [&](std::size_t c) {
+        for (std::size_t s = songs.size() * c / chunks; s < songs.size() * (c + 1) / chunks; ++s) {
+            std::uint64_t at = store.m_songOffsets[s];
+            for (const Chord& chord : songs[s].chords()) {
+                const int root = noteToVal(chord.rootView());
+                const std::string_view on = chord.onView();
+                store.m_roots[at] = static_cast<std::uint8_t>(root);
+                store.m_basses[at] = static_cast<std::uint8_t>(on.empty() ? root : noteToVal(on));
+                store.m_masks[at] = static_cast<std::uint16_t>(chord.pitchClassMask());
+                std::string name = chord.quality()->getQualityName();
+                auto it = ids.find(name);
+                if (it != ids.end()) {
+                    store.m_qualities[at] = it->second;
+                } else {
+                    store.m_qualities[at] = UNKNOWN_QUALITY;
+                    unknown[c].emplace_back(at, std::move(name));
+                }
+                ++at;
+            }
+        }
+    });
+    for (auto& list : unknown) {
+        for (auto& entry : list) {
+            auto it = ids.find(entry.second);
+            if (it == ids.end()) {
+                if (store.m_qualityNames.size() >= UNKNOWN_QUALITY) {
+                    throw std::runtime_error("ProgressionStore: too many distinct qualities.");
+                }
+                it = ids.emplace(entry.second, static_cast<std::uint16_t>(store.m_qualityNames.size())).first;
+                store.m_qualityNames.push_back(entry.second);
+            }
+            store.m_qualities[entry.first] = it->second;
+        }
+    }
+    return store;
+}
+
+std::size_t ProgressionStore::songCount() const {
+    return m_songOffsets.size() - 1;
+}
+
+std::size_t ProgressionStore::chordCount() const {
+    return m_roots.size();
+}
+
+const std::vector<std::uint8_t>& ProgressionStore::roots() const {
+    return m_roots;
+}
+
+const std::vector<std::uint8_t>& ProgressionStore::basses() const {
+    return m_basses;
+}
+
+const std::vector<std::uint16_t>& ProgressionStore::qualities() const {
+    return m_qualities;
+}
+
+const std::vector<std::uint16_t>& ProgressionStore::masks() const {
+    return m_masks;
+}
+
+const std::vector<std::uint64_t>& ProgressionStore::songOffsets() const {
+    return m_songOffsets;
+}
+
+const std::vector<std::string>& ProgressionStore::qualityNames() const {
+    return m_qualityNames;
+}
+
+std::vector<std::uint64_t> ProgressionStore::qualityHistogram(unsigned threads) const {
+    const std::uint16_t* q = m_qualities.data();
+    return countBy(m_qualityNames.size(), [q](std::size_t i) { return q[i]; }, threads);
+}
+
+std::vector<std::uint64_t> ProgressionStore::rootHistogram(unsigned threads) const {
+    const std::uint8_t* r = m_roots.data();
+    return countBy(12, [r](std::size_t i) { return r[i]; }, threads);
+}
+
+std::vector<std::uint64_t> ProgressionStore::rootMotionHistogram(unsigned threads) const {
+    const unsigned workers = workerCount(threads, chordCount());
+    std::vector<std::uint64_t> partial(workers * 12, 0);
+    const std::uint8_t* r = m_roots.data();
+    forEachSongRange(threads, [&](std::size_t w, std::size_t first, std::size_t last) {
+        std::uint64_t counts[12] = {};
+        for (std::size_t s = first; s < last; ++s) {
+            const std::size_t end = static_cast<std::size_t>(m_songOffsets[s + 1]);
+            for (std::size_t i = static_cast<std::size_t>(m_songOffsets[s]) + 1; i < end; ++i) {
+                ++counts[(r[i] + 12 - r[i - 1]) % 12];
+            }
+        }
+        std::copy(counts, counts + 12, partial.begin() + static_cast<std::ptrdiff_t>(w * 12));
+    });
+    std::vector<std::uint64_t> counts(12, 0);
+    for (std::size_t i = 0; i < partial.size(); ++i) counts[i % 12] += partial[i];
+    return counts;
+}
+
+std::vector<std::uint64_t> ProgressionStore::transitionCounts(unsigned threads) const {
+    const std::size_t q = m_qualityNames.size();
+    const std::size_t buckets = q * 12 * q;
+    const unsigned workers = workerCount(threads, chordCount());
+    std::vector<std::vector<std::uint64_t>> partial(workers);
+    const std::uint8_t* r = m_roots.data();
+    const std::uint16_t* k = m_qualities.data();
+    forEachSongRange(threads, [&](std::size_t w, std::size_t first, std::size_t last) {
+        std::vector<std::uint64_t>& counts = partial[w];
+        counts.assign(buckets, 0);
+        for (std::size_t s = first; s < last; ++s) {
+            const std::size_t end = static_cast<std::size_t>(m_songOffsets[s + 1]);
+            for (std::size_t i = static_cast<std::size_t>(m_songOffsets[s]) + 1; i < end; ++i) {
+                ++counts[(k[i - 1] * 12 + (r[i] + 12 - r[i - 1]) % 12) * q + k[i]];
+            }
+        }
+    });
+    std::vector<std::uint64_t> counts(buckets, 0);
+    for (const auto& part : partial) {
+        for (std::size_t b = 0; b < buckets; ++b) counts[b] += part[b];
+    }
+    return counts;
+}
+
+std::vector<std::uint8_t> ProgressionStore::songKeys(unsigned threads) const {
+    std::vector<std::uint8_t> keys(songCount(), 0);
+    const std::uint16_t* m = m_masks.data();
+    forEachSongRange(threads, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t s = first; s < last; ++s) {
+            // Pitch-class counts: a branch-free loop over the bits of each mask
+            std::uint64_t counts[12] = {};
+            const std::size_t end = static_cast<std::size_t>(m_songOffsets[s + 1]);
+            if (m_songOffsets[s] == end) {
+                keys[s] = NO_KEY;
+                continue;
+            }
+            for (std::size_t i = static_cast<std::size_t>(m_songOffsets[s]); i < end; ++i) {
+                const unsigned mask = m[i];
+                for (int pc = 0; pc < 12; ++pc) counts[pc] += (mask >> pc) & 1u;
+            }
+            keys[s] = static_cast<std::uint8_t>(estimateKey(counts));
+        }
+    });
+    return keys;
+}
+
+std::vector<std::uint64_t> ProgressionStore::keyHistogram(unsigned threads) const {
+    const std::vector<std::uint8_t> keys = songKeys(threads);
+    std::vector<std::uint64_t> counts(24, 0);
+    for (std::uint8_t key : keys) {
+        if (key != NO_KEY) ++counts[key];
+    }
+    return counts;
+}
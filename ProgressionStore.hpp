@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChordProgression.hpp"
+#include "Parallel.hpp"
+
+/**
+ * Column store of a chord corpus for analytics: one flat array per field
+ * (root, bass, quality id, pitch-class mask) plus song offsets, so a count
+ * over 100M chords streams a few hundred MB of small integers instead of
+ * chasing Chord objects.
+ *
+ * Song s owns chords [songOffsets()[s], songOffsets()[s + 1]). Quality ids
+ * index qualityNames(); the default qualities come first, in
+ * DEFAULT_QUALITIES order, then names first seen in the corpus.
+ *
+ * The kernels split the columns across 'threads' workers (0 = hardware
+ * concurrency), count into per-worker tables and add them up.
+ */
+class ProgressionStore {
+public:
+    ProgressionStore();
+
+    // Build from many songs in parallel
+    static ProgressionStore build(const std::vector<ChordProgression>& songs, unsigned threads = 0);
+
+    std::size_t songCount() const;
+    std::size_t chordCount() const;
+
+    const std::vector<std::uint8_t>& roots() const;       // pitch class
+    const std::vector<std::uint8_t>& basses() const;      // slash note's pitch class, else the root
+    const std::vector<std::uint16_t>& qualities() const;  // index into qualityNames()
+    const std::vector<std::uint16_t>& masks() const;      // sounding pitch classes, bit 0 = C
+    const std::vector<std::uint64_t>& songOffsets() const;
+    const std::vector<std::string>& qualityNames() const;
+
+    // Chords per quality id
+    std::vector<std::uint64_t> qualityHistogram(unsigned threads = 0) const;
+    // Chords per root pitch class (12)
+    std::vector<std::uint64_t> rootHistogram(unsigned threads = 0) const;
+    // Root motion (0..11 semitones up) between consecutive chords of a song
+    std::vector<std::uint64_t> rootMotionHistogram(unsigned threads = 0) const;
+    /**
+     * Consecutive chord pairs of a song grouped by (quality a, root motion,
+     * quality b): entry (a * 12 + motion) * qualityNames().size() + b.
+     */
+    std::vector<std::uint64_t> transitionCounts(unsigned threads = 0) const;
+    // Songs per estimated key (24: [0..11] major on C..B, [12..23] minor), see estimateKey()
+    std::vector<std::uint64_t> keyHistogram(unsigned threads = 0) const;
+    // Estimated key of every song, NO_KEY for songs without chords
+    std::vector<std::uint8_t> songKeys(unsigned threads = 0) const;
+    static constexpr std::uint8_t NO_KEY = 0xFF;
+
+    /**
+     * Generic group-by count over chords: bucket(i) must return a value below
+     * 'buckets' for chord i. Inline so the key function is compiled into the loop.
+     */
+    template <class BucketFn>
+    std::vector<std::uint64_t> countBy(std::size_t buckets, BucketFn bucket, unsigned threads = 0) const;
+
+private:
+    std::vector<std::uint8_t> m_roots;
+    std::vector<std::uint8_t> m_basses;
+    std::vector<std::uint16_t> m_qualities;
+    std::vector<std::uint16_t> m_masks;
+    std::vector<std::uint64_t> m_songOffsets;
+    std::vector<std::string> m_qualityNames;
+
+    // Calls fn(worker, firstSong, lastSong) over ranges of about equal chord counts
+    template <class Fn>
+    void forEachSongRange(unsigned threads, Fn&& fn) const;
+    static unsigned workerCount(unsigned threads, std::size_t items);
+};
+
+inline unsigned ProgressionStore::workerCount(unsigned threads, std::size_t items) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Below ~64K items per worker the thread start-up costs more than it saves
+    const std::size_t useful = std::max<std::size_t>(1, items / 65536);
+    return static_cast<unsigned>(std::min<std::size_t>(threads, useful));
+}
+
+template <class BucketFn>
+std::vector<std::uint64_t> ProgressionStore::countBy(std::size_t buckets, BucketFn bucket,
+                                                     unsigned threads) const {
+    const std::size_t n = chordCount();
+    const unsigned workers = workerCount(threads, n);
+    std::vector<std::vector<std::uint64_t>> partial(workers);
+    parallelFor(workers, workers, [&](std::size_t w) {
+        // Four interleaved tables: repeated keys do not serialize on one counter
+        std::vector<std::uint32_t> tables(4 * buckets, 0);
+        std::vector<std::uint64_t>& total = partial[w];
+        total.assign(buckets, 0);
+        const std::size_t first = n * w / workers;
+        const std::size_t last = n * (w + 1) / workers;
+        std::size_t i = first;
+        while (i < last) {
+            // Flush before 32-bit counters could overflow
+            const std::size_t stop = std::min(last, i + (std::size_t(1) << 30));
+            for (; i + 4 <= stop; i += 4) {
+                ++tables[bucket(i)];
+                ++tables[buckets + bucket(i + 1)];
+                ++tables[2 * buckets + bucket(i + 2)];
+                ++tables[3 * buckets + bucket(i + 3)];
+            }
+            for (; i < stop; ++i) {
+                ++tables[bucket(i)];
+            }
+            for (std::size_t b = 0; b < buckets; ++b) {
+                total[b] += std::uint64_t(tables[b]) + tables[buckets + b] +
+                            tables[2 * buckets + b] + tables[3 * buckets + b];
+            }
+            std::fill(tables.begin(), tables.end(), 0u);
+        }
+    });
+    std::vector<std::uint64_t> counts(buckets, 0);
+    for (const auto& part : partial) {
+        for (std::size_t b = 0; b < buckets; ++b) counts[b] += part[b];
+    }
+    return counts;
+}
+
+template <class Fn>
+void ProgressionStore::forEachSongRange(unsigned threads, Fn&& fn) const {
+    const std::size_t songs = songCount();
+    const unsigned workers = workerCount(threads, chordCount());
+    parallelFor(workers, workers, [&](std::size_t w) {
+        // Split by chord position, then snap to song boundaries
+        const std::uint64_t from = chordCount() * w / workers;
+        const std::uint64_t to = chordCount() * (w + 1) / workers;
+        const std::size_t first = static_cast<std::size_t>(
+            std::lower_bound(m_songOffsets.begin(), m_songOffsets.begin() + songs, from) - m_songOffsets.begin());
+        const std::size_t last = w + 1 == workers ? songs : static_cast<std::size_t>(
+            std::lower_bound(m_songOffsets.begin(), m_songOffsets.begin() + songs, to) - m_songOffsets.begin());
+        fn(w, first, last);
+    });
+}
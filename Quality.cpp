@@ -3,21 +3,36 @@
 #include <stdexcept>
 #include <algorithm>
 
-Quality::Quality(const std::string& name, const std::vector<int>& components)
-    : m_qualityName(name),
-      m_components(components)
+Quality::Quality(const std::string& name, const std::vector<int>& components,
+                 const allocator_type& alloc)
+    : m_qualityName(name.begin(), name.end(), alloc),
+      m_components(components.begin(), components.end(), alloc)
+{
+}
+
+Quality::Quality(const Quality& other, const allocator_type& alloc)
+    : m_qualityName(other.m_qualityName, alloc),
+      m_components(other.m_components, alloc)
 {
 }
 
 std::string Quality::getQualityName() const {
-    return m_qualityName;
+    return std::string(m_qualityName);
+}
+
+const std::pmr::vector<int>& Quality::getIntervals() const {
+    return m_components;
+}
+
+Quality::allocator_type Quality::get_allocator() const {
+    return m_qualityName.get_allocator();
 }
 
 /**
  * Returns either numeric intervals or note names for this chord
  * from the given root.
  */
-std::vector<int> Quality::getComponents(const std::string& root, bool visible) const {
+std::vector<int> Quality::getComponents(std::string_view root, bool visible) const {
     // We'll store the raw intervals and possibly convert if visible=true.
     // But let's keep logic consistent with Python: if visible, we do note-names,
     // but let's do a two-step approach:
@@ -42,12 +57,28 @@ std::vector<int> Quality::getComponents(const std::string& root, bool visible) c
     return absValues;
 }
 
+void Quality::invertIntervals(std::vector<int>& intervals) {
+    if (intervals.size() < 2) {
+        return;
+    }
+    int first = intervals.front();
+    while (first <= intervals.back()) {
+        first += 12;
+    }
+    intervals.erase(intervals.begin());
+    intervals.push_back(first);
+    const int offset = intervals.front();
+    for (auto& v : intervals) {
+        v -= offset;
+    }
+}
+
 /**
  * Reorders intervals so that 'onChord' is the lowest note. 
  * Example from Python: 
  *     if onChordVal is found in the intervals, remove and re-insert it in front, etc.
  */
-void Quality::appendOnChord(const std::string& onChord, const std::string& root) {
+void Quality::appendOnChord(std::string_view onChord, std::string_view root) {
     int rv = noteToVal(root);
     int onVal = noteToVal(onChord);
 
@@ -59,7 +90,7 @@ void Quality::appendOnChord(const std::string& onChord, const std::string& root)
     // Then insert relOnVal at front if not present.
     // If relOnVal is higher, we might reduce by 12 to keep chord tidy.
 
-    std::vector<int> newComponents;
+    std::pmr::vector<int> newComponents(m_components.get_allocator());
     newComponents.reserve(m_components.size());
 
     // Remove any occurrence that matches relOnVal mod 12:
@@ -85,7 +116,7 @@ void Quality::appendOnChord(const std::string& onChord, const std::string& root)
     // (In Python code we do an unconditional insert. We'll replicate that.)
     newComponents.insert(newComponents.begin(), relOnVal);
 
-    m_components = newComponents;
+    m_components = std::move(newComponents);
 }
 
 bool Quality::operator==(const Quality& other) const {
@@ -96,6 +127,6 @@ bool Quality::operator==(const Quality& other) const {
     return (m_components == other.m_components);
 }
 
-int Quality::rootVal(const std::string& root) const {
+int Quality::rootVal(std::string_view root) const {
     return noteToVal(root);
 }
@@ -1,31 +1,49 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory_resource>
 
 /**
  * Represents a chord quality, e.g. "maj7", with intervals from the root.
+ *
+ * Allocator-aware: name and intervals live in the memory resource given at
+ * construction (the default resource if none), so a batch of chords can be
+ * placed in one std::pmr::monotonic_buffer_resource and released at once.
  */
 
 class Quality {
 public:
-    Quality(const std::string& name, const std::vector<int>& components);
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    Quality(const std::string& name, const std::vector<int>& components,
+            const allocator_type& alloc = allocator_type());
+    Quality(const Quality& other, const allocator_type& alloc = allocator_type());
 
     // Accessors
     std::string getQualityName() const;
-    std::vector<int> getComponents(const std::string& root, bool visible = false) const;
+    std::vector<int> getComponents(std::string_view root, bool visible = false) const;
+    // Raw intervals from the root, without copying
+    const std::pmr::vector<int>& getIntervals() const;
+
+    allocator_type get_allocator() const;
 
     // For slash chords: modifies the internal intervals so that the slash note is "lowest".
-    void appendOnChord(const std::string& onChord, const std::string& root);
+    void appendOnChord(std::string_view onChord, std::string_view root);
+
+    // One inversion step: the lowest interval moves up an octave (or more) to the top,
+    // then everything is re-based on the new lowest
+    static void invertIntervals(std::vector<int>& intervals);
 
     // Operators
     bool operator==(const Quality& other) const;
     bool operator!=(const Quality& other) const { return !(*this == other); }
 
 private:
-    std::string m_qualityName;
-    std::vector<int> m_components; // intervals from root
+    std::pmr::string m_qualityName;
+    std::pmr::vector<int> m_components; // intervals from root
 
     // Helpers
-    int rootVal(const std::string& root) const;
+    int rootVal(std::string_view root) const;
 };
@@ -1,23 +1,152 @@
 #include "QualityManager.hpp"
 #include "Constants.hpp"
+#include "Metrics.hpp"
 #include <stdexcept>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 QualityManager& QualityManager::Instance() {
     static QualityManager instance;
     return instance;
 }
 
-QualityManager::QualityManager() {
-    loadDefaultQualities();
+QualityManager::QualityManager()
+    : m_table(defaultTable())
+{
+}
+
+QualityManager::QualityManager(std::shared_ptr<const Table> table)
+    : m_table(std::move(table))
+{
+}
+
+std::shared_ptr<const QualityManager::Table> QualityManager::defaultTable() {
+    static const std::shared_ptr<const Table> table = [] {
+        auto t = std::make_shared<Table>();
+        for (const auto& pair : DEFAULT_QUALITIES) {
+            const std::string& qname = pair.first;
+            const std::vector<int>& comps = pair.second;
+            // The registry outlives any arena, so it never uses the default resource
+            t->qualities[qname] = std::make_shared<Quality>(qname, comps, std::pmr::new_delete_resource());
+        }
+        rebuildIntervalIndex(*t);
+        return t;
+    }();
+    return table;
 }
 
 void QualityManager::loadDefaultQualities() {
-    m_qualities.clear();
-    for (const auto& pair : DEFAULT_QUALITIES) {
-        const std::string& qname = pair.first;
-        const std::vector<int>& comps = pair.second;
-        m_qualities[qname] = std::make_shared<Quality>(qname, comps);
+    m_table = defaultTable();
+}
+
+QualityManager::Table& QualityManager::mutableTable() {
+    if (const auto& snapshot = m_table->snapshot) {
+        auto table = std::make_shared<Table>();
+        for (std::size_t e = 0; e < snapshot->size(); ++e) {
+            std::string name(snapshot->name(e));
+            table->qualities[name] = std::make_shared<Quality>(name, snapshot->intervals(e).toVector(),
+                                                               std::pmr::new_delete_resource());
+        }
+        rebuildIntervalIndex(*table);
+        m_table = std::move(table);
+    } else if (m_table.use_count() != 1) {
+        // Quality objects are immutable once registered, so the copy shares them
+        m_table = std::make_shared<Table>(*m_table);
+    }
+    return const_cast<Table&>(*m_table);
+}
+
+bool QualityManager::sharesTableWith(const QualityManager& other) const {
+    return m_table == other.m_table;
+}
+
+static std::string trimmed(const std::string& s) {
+    const auto begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+}
+
+void QualityManager::loadDefinitions(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open quality definitions: " + path);
+    }
+    // Parse everything first, so a bad file leaves the registry unchanged
+    std::vector<std::pair<std::string, std::vector<int>>> definitions;
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); ++lineNumber) {
+        line = trimmed(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        auto malformed = [&] {
+            return std::runtime_error("Malformed quality definition at " + path + ":" + std::to_string(lineNumber));
+        };
+        const auto eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw malformed();
+        }
+        std::vector<int> intervals;
+        std::istringstream values(line.substr(eq + 1));
+        int v;
+        while (values >> v) {
+            intervals.push_back(v);
+        }
+        if (!values.eof() || intervals.empty()) {
+            throw malformed();
+        }
+        definitions.emplace_back(trimmed(line.substr(0, eq)), std::move(intervals));
+    }
+
+    Table& table = mutableTable();
+    for (const auto& d : definitions) {
+        table.qualities[d.first] = std::make_shared<Quality>(d.first, d.second, std::pmr::new_delete_resource());
+    }
+    rebuildIntervalIndex(table);
+}
+
+void QualityManager::saveSnapshot(const std::string& path) const {
+    std::map<std::string, std::vector<int>> qualities;
+    if (const auto& snapshot = m_table->snapshot) {
+        for (std::size_t e = 0; e < snapshot->size(); ++e) {
+            qualities[std::string(snapshot->name(e))] = snapshot->intervals(e).toVector();
+        }
+    } else {
+        for (const auto& kv : m_table->qualities) {
+            const auto& intervals = kv.second->getIntervals();
+            qualities[kv.first].assign(intervals.begin(), intervals.end());
+        }
+    }
+    QualitySnapshot::write(path, qualities);
+}
+
+QualityManager QualityManager::fromSnapshot(const std::string& path) {
+    auto table = std::make_shared<Table>();
+    table->snapshot = QualitySnapshot::open(path);
+    return QualityManager(std::move(table));
+}
+
+std::vector<int> QualityManager::normalizedIntervals(const Quality& quality) {
+    const auto& intervals = quality.getIntervals();
+    std::vector<int> normalized(intervals.begin(), intervals.end());
+    std::sort(normalized.begin(), normalized.end());
+    if (!normalized.empty()) {
+        int shift = normalized[0];
+        for (auto &v : normalized) {
+            v -= shift;
+        }
+    }
+    return normalized;
+}
+
+void QualityManager::rebuildIntervalIndex(Table& table) {
+    table.intervalIndex.clear();
+    for (const auto& kv : table.qualities) {
+        // emplace keeps the first (alphabetically smallest) name, as the old linear scan did
+        table.intervalIndex.emplace(normalizedIntervals(*kv.second), kv.second);
     }
 }
 
@@ -25,89 +154,80 @@ void QualityManager::loadDefaultQualities() {
  * If name is known, returns a new copy of that Quality.
  * If 'inversion' > 0, we shift intervals accordingly.
  */
-std::shared_ptr<Quality> QualityManager::getQuality(const std::string& name, int inversion) {
-    auto it = m_qualities.find(name);
-    if (it == m_qualities.end()) {
+std::shared_ptr<Quality> QualityManager::getQuality(const std::string& name, int inversion,
+                                                    const Quality::allocator_type& alloc) const {
+    CYCHORD_METRIC_TIMER(Metric::GetQuality);
+    // polymorphic_allocator passes 'alloc' on to the Quality itself
+    std::pmr::polymorphic_allocator<Quality> qualityAlloc(alloc);
+
+    if (const auto& snapshot = m_table->snapshot) {
+        const long entry = snapshot->find(name);
+        if (entry < 0) {
+            throw std::runtime_error("Unknown quality: " + name);
+        }
+        const auto base = snapshot->intervals(entry);
+        if (inversion <= 0) {
+            return std::allocate_shared<Quality>(qualityAlloc, name, base.toVector());
+        }
+        if (static_cast<std::size_t>(inversion) < base.size) {
+            return std::allocate_shared<Quality>(qualityAlloc, name, snapshot->inversion(entry, inversion).toVector());
+        }
+        std::vector<int> intervals = base.toVector();
+        for (int i = 0; i < inversion; ++i) {
+            Quality::invertIntervals(intervals);
+        }
+        return std::allocate_shared<Quality>(qualityAlloc, name, intervals);
+    }
+
+    auto it = m_table->qualities.find(name);
+    if (it == m_table->qualities.end()) {
         throw std::runtime_error("Unknown quality: " + name);
     }
     // Create a new copy
-    auto q = std::make_shared<Quality>(*it->second);
+    if (inversion <= 0) {
+        return std::allocate_shared<Quality>(qualityAlloc, *it->second);
+    }
 
     // Inversion: "rotate" intervals n times
+    const auto& base = it->second->getIntervals();
+    std::vector<int> intervals(base.begin(), base.end());
     for (int i = 0; i < inversion; ++i) {
-        if (!q->getComponents("C").empty()) {
-            // We want to rotate the front interval to the back, adding 12 if needed
-            // For clarity, let's do something like:
-            auto comps = q->getComponents("C", false); // absolute intervals from root "C"
-            // But actually we stored the raw intervals in m_components. We can do direct manipulation:
-            // We'll do a small workaround: let's define a function to get the "raw" intervals from the
-            // python approach. But we haven't stored that in the public interface.
-            // For simplicity in C++: let's replicate the rotation logic as in Python:
-
-            // We'll actually store the intervals from the original q. Then reassign them:
-            std::vector<int> intervals = it->second->getComponents("C", false);
-            // That won't reflect the current state if we invert multiple times.
-            // So let's do something simpler: We'll store a local copy of the q's intervals from root=0 approach.
-            // Because each rotation is incremental.
-            auto baseComps = q->getComponents("C", false);
-
-            // We'll shift the actual underlying data. Let's approximate it:
-            // We do something like:
-            // front = baseComps[0], remove it from the front, add 12 until it's above the last item
-            // then push it to the back.
-
-            // This is actually somewhat more involved to do robustly. For now, let's keep it simpler:
-            // We'll do a single rotation that the Python code did:
-            //    n = q.components[0]
-            //    while n < q.components[-1]:
-            //        n += 12
-            //    q.components = q.components[1:] + (n,)
-
-            // We'll simulate that by direct access to m_qualities, but that's private.
-            // For a simpler approach, we can interpret "inversion" as shifting the first
-            // interval up by an octave and moving it to the back. We'll approximate:
-
-            // Not 100% identical to Python if repeated. But let's do a single shift:
-
-            // We can do a manual approach: we know the internal stored intervals are
-            // (0, x, y, z). We'll read them from it->second, but that won't incorporate
-            // prior inversions. Let's do it on q itself:
-
-            std::vector<int> newAbs = q->getComponents("C", false);
-            if (newAbs.size() < 2) continue;
-
-            int first = newAbs[0];
-            int last = newAbs[newAbs.size() - 1];
-            // Increase 'first' until it is > last:
-            while (first <= last) {
-                first += 12;
-            }
-            // Then remove front, push back:
-            newAbs.erase(newAbs.begin());
-            newAbs.push_back(first);
-
-            // Now we re-set q by constructing a fresh Quality with these intervals minus the root
-            // Actually, to get them back into relative form, we subtract the (new) smallest from all:
-            // The new root is newAbs[0], which might not be 0 any more. Let's store that offset:
-            int offset = newAbs[0];
-            for (auto &val : newAbs) {
-                val -= offset;
-            }
+        Quality::invertIntervals(intervals);
+    }
+    return std::allocate_shared<Quality>(qualityAlloc, it->second->getQualityName(), intervals);
+}
 
-            // We create a new Quality with the name the same but new intervals
-            auto newQ = std::make_shared<Quality>(q->getQualityName(), newAbs);
-            q = newQ;
-        }
+bool QualityManager::hasQuality(const std::string& name) const {
+    if (m_table->snapshot) {
+        return m_table->snapshot->find(name) >= 0;
     }
+    return m_table->qualities.find(name) != m_table->qualities.end();
+}
 
-    return q;
+std::vector<std::string> QualityManager::qualityNames() const {
+    std::vector<std::string> names;
+    if (const auto& snapshot = m_table->snapshot) {
+        names.reserve(snapshot->size());
+        for (std::size_t i = 0; i < snapshot->size(); ++i) {
+            names.emplace_back(snapshot->name(i));
+        }
+        return names;
+    }
+    names.reserve(m_table->qualities.size());
+    for (const auto& entry : m_table->qualities) {
+        names.push_back(entry.first);
+    }
+    return names;
 }
 
 void QualityManager::setQuality(const std::string& name, const std::vector<int>& components) {
-    m_qualities[name] = std::make_shared<Quality>(name, components);
+    Table& table = mutableTable();
+    table.qualities[name] = std::make_shared<Quality>(name, components, std::pmr::new_delete_resource());
+    rebuildIntervalIndex(table);
 }
 
-std::shared_ptr<Quality> QualityManager::findQualityFromComponents(const std::vector<int>& components) {
+std::shared_ptr<Quality> QualityManager::findQualityFromComponents(const std::vector<int>& components) const {
+    CYCHORD_METRIC_SCOPE(timer, Metric::FindQualityMiss);
     // Normalize input so the first interval is 0
     if (components.empty()) {
         return nullptr;
@@ -120,23 +240,33 @@ std::shared_ptr<Quality> QualityManager::findQualityFromComponents(const std::ve
         val -= base;
     }
 
-    // 1) First pass: Exact match
-    for (const auto& kv : m_qualities) {
-        auto qualityPtr = kv.second; // shared_ptr<Quality>
-        // Retrieve this chord quality's intervals from root=0
-        std::vector<int> refIntervals = qualityPtr->getComponents("C", false);
-        std::sort(refIntervals.begin(), refIntervals.end());
-        if (!refIntervals.empty()) {
-            int shift = refIntervals[0];
-            for (auto &v : refIntervals) {
-                v -= shift;
+    if (const auto& snapshot = m_table->snapshot) {
+        // Same two passes over the snapshot's tables (entries are in name order)
+        const long exact = snapshot->findByIntervals(normalized);
+        long match = exact;
+        for (std::size_t e = 0; match < 0 && e < snapshot->size(); ++e) {
+            const auto ref = snapshot->normalized(e);
+            if (std::includes(ref.data, ref.data + ref.size, normalized.begin(), normalized.end())) {
+                match = static_cast<long>(e);
             }
         }
-        // Compare for exact equality
-        if (refIntervals == normalized) {
-            // Return a new copy of that quality
-            return std::make_shared<Quality>(*qualityPtr);
+        if (match < 0) {
+            return nullptr;
         }
+        if (exact >= 0) {
+            CYCHORD_METRIC_RETAG(timer, Metric::FindQualityExact);
+        } else {
+            CYCHORD_METRIC_RETAG(timer, Metric::FindQualitySubset);
+        }
+        return std::make_shared<Quality>(std::string(snapshot->name(match)), snapshot->intervals(match).toVector());
+    }
+
+    // 1) First pass: Exact match, via the interval index
+    auto exact = m_table->intervalIndex.find(normalized);
+    if (exact != m_table->intervalIndex.end()) {
+        CYCHORD_METRIC_RETAG(timer, Metric::FindQualityExact);
+        // Return a new copy of that quality
+        return std::make_shared<Quality>(*exact->second);
     }
 
     // 2) Second pass: Subset match
@@ -160,7 +290,7 @@ std::shared_ptr<Quality> QualityManager::findQualityFromComponents(const std::ve
         return (i == small.size());
     };
 
-    for (const auto& kv : m_qualities) {
+    for (const auto& kv : m_table->qualities) {
         auto qualityPtr = kv.second;
         // Retrieve intervals from root=0 (same approach as above)
         std::vector<int> refIntervals = qualityPtr->getComponents("C", false);
@@ -174,6 +304,7 @@ std::shared_ptr<Quality> QualityManager::findQualityFromComponents(const std::ve
         // Check if our normalized intervals are a subset of refIntervals
         if (isSubset(normalized, refIntervals)) {
             // Found a subset match: "missing tones" chord
+            CYCHORD_METRIC_RETAG(timer, Metric::FindQualitySubset);
             return std::make_shared<Quality>(*qualityPtr);
         }
     }
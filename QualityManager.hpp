@@ -5,32 +5,91 @@
 #include <vector>
 #include <map>
 #include "Quality.hpp"
+#include "QualitySnapshot.hpp"
 
 /**
- * Manages a dictionary of chord qualities (singleton).
+ * Manages a dictionary of chord qualities.
+ *
+ * Instance() is the process-wide registry used when none is passed in.
+ * Independent registries (e.g. one per tenant) are plain objects: a new one
+ * starts from the built-in defaults and copies are cheap, since the table is
+ * shared copy-on-write until setQuality or loadDefaultQualities changes it.
+ * Const member functions may be called from any number of threads; a
+ * registry that is being modified must not be used concurrently.
+ *
+ * Vocabularies can come from a text file (loadDefinitions) and be compiled
+ * into a binary snapshot (saveSnapshot); fromSnapshot maps such a file and
+ * serves lookups from it directly, so start-up does no parsing or building.
  */
 
 class QualityManager {
 public:
-    // Singleton accessor
+    // Process-wide registry
     static QualityManager& Instance();
 
-    // Load default chord qualities from the global DEFAULT_QUALITIES
+    // A registry with the default qualities (shares the built-in table)
+    QualityManager();
+    QualityManager(const QualityManager& other) = default;
+    QualityManager& operator=(const QualityManager& other) = default;
+    QualityManager(QualityManager&& other) noexcept = default;
+    QualityManager& operator=(QualityManager&& other) noexcept = default;
+
+    // Reset to the default chord qualities from the global DEFAULT_QUALITIES
     void loadDefaultQualities();
 
-    // Return a (dynamically created) Quality with optional inversion
-    std::shared_ptr<Quality> getQuality(const std::string& name, int inversion = 0);
+    /**
+     * Add or replace the qualities defined in a text file, one per line:
+     *     name = 0 4 7 11    # comment
+     * An empty name (" = 0 4 7") is the plain major chord. Throws
+     * std::runtime_error naming the line of the first malformed definition.
+     */
+    void loadDefinitions(const std::string& path);
+
+    // Write every quality of this registry, with its lookup tables, as a snapshot file
+    void saveSnapshot(const std::string& path) const;
+
+    // A registry backed by a mapped snapshot file; the first setQuality copies it into memory
+    static QualityManager fromSnapshot(const std::string& path);
+
+    // Return a (dynamically created) Quality with optional inversion,
+    // allocated (object and control block) from 'alloc'
+    std::shared_ptr<Quality> getQuality(const std::string& name, int inversion = 0,
+                                        const Quality::allocator_type& alloc = Quality::allocator_type()) const;
+
+    // Whether a quality with this name is registered
+    bool hasQuality(const std::string& name) const;
+
+    // Every registered quality name, in name order
+    std::vector<std::string> qualityNames() const;
 
     // Set or add a custom quality
     void setQuality(const std::string& name, const std::vector<int>& components);
 
     // Find a quality whose intervals match exactly
-    std::shared_ptr<Quality> findQualityFromComponents(const std::vector<int>& components);
+    std::shared_ptr<Quality> findQualityFromComponents(const std::vector<int>& components) const;
+
+    // Whether this registry still shares its table with another one
+    bool sharesTableWith(const QualityManager& other) const;
 
 private:
-    QualityManager(); // private constructor
-    QualityManager(const QualityManager&) = delete;
-    QualityManager& operator=(const QualityManager&) = delete;
+    struct Table {
+        // When set, lookups go to the snapshot and the maps below are empty
+        std::shared_ptr<const QualitySnapshot> snapshot;
+
+        std::map<std::string, std::shared_ptr<Quality>> qualities;
+
+        // Normalized (sorted, 0-based) intervals => first quality with them in name order.
+        // Serves the exact-match pass of findQualityFromComponents with one lookup.
+        std::map<std::vector<int>, std::shared_ptr<Quality>> intervalIndex;
+    };
+
+    // Never modified once shared; writers copy it first
+    std::shared_ptr<const Table> m_table;
+
+    explicit QualityManager(std::shared_ptr<const Table> table);
 
-    std::map<std::string, std::shared_ptr<Quality>> m_qualities;
+    static std::shared_ptr<const Table> defaultTable();
+    Table& mutableTable();
+    static std::vector<int> normalizedIntervals(const Quality& quality);
+    static void rebuildIntervalIndex(Table& table);
 };
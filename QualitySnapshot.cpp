@@ -0,0 +1,217 @@
+#include "QualitySnapshot.hpp"
+#include "Quality.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+static const std::uint32_t SNAPSHOT_VERSION = 1;
+
+static std::uint32_t slotCountFor(std::size_t entries) {
+    std::uint32_t slots = 2;
+    while (slots < entries * 2) slots <<= 1;
+    return slots;
+}
+
+std::uint32_t QualitySnapshot::hashName(std::string_view name) {
+    std::uint32_t h = 2166136261u;  // FNV-1a
+    for (unsigned char c : name) {
+        h = (h ^ c) * 16777619u;
+    }
+    return h;
+}
+
+std::uint32_t QualitySnapshot::hashIntervals(const std::int32_t* data, std::size_t size) {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        h = (h ^ static_cast<std::uint32_t>(data[i])) * 16777619u;
+    }
+    return h;
+}
+
+void QualitySnapshot::write(const std::string& path, const std::map<std::string, std::vector<int>>& qualities) {
+    std::vector<Entry> entries;
+    std::vector<std::int32_t> ints;
+    std::string names;
+    for (const auto& kv : qualities) {
+        const std::vector<int>& raw = kv.second;
+        if (kv.first.size() > 0xFFFF || raw.size() > 0xFFFF) {
+            throw std::runtime_error("Quality too large for a snapshot: " + kv.first);
+        }
+        Entry e{};
+        e.nameOffset = static_cast<std::uint32_t>(names.size());
+        e.nameLength = static_cast<std::uint32_t>(kv.first.size());
+        e.nameHash = hashName(kv.first);
+        names += kv.first;
+
+        e.count = static_cast<std::uint32_t>(raw.size());
+        e.intervals = static_cast<std::uint32_t>(ints.size());
+        ints.insert(ints.end(), raw.begin(), raw.end());
+
+        std::vector<int> normalized = raw;
+        std::sort(normalized.begin(), normalized.end());
+        if (!normalized.empty()) {
+            const int shift = normalized[0];
+            for (auto& v : normalized) v -= shift;
+        }
+        e.normalized = static_cast<std::uint32_t>(ints.size());
+        ints.insert(ints.end(), normalized.begin(), normalized.end());
+        e.intervalHash = hashIntervals(ints.data() + e.normalized, normalized.size());
+
+        e.inversions = static_cast<std::uint32_t>(ints.size());
+        std::vector<int> inverted = raw;
+        for (std::size_t k = 1; k < raw.size(); ++k) {
+            Quality::invertIntervals(inverted);
+            ints.insert(ints.end(), inverted.begin(), inverted.end());
+        }
+        entries.push_back(e);
+    }
+
+    // Open addressing, linear probing; the interval table keeps the first name per key
+    const std::uint32_t nameSlots = slotCountFor(entries.size());
+    const std::uint32_t intervalSlots = slotCountFor(entries.size());
+    std::vector<std::uint32_t> byName(nameSlots, 0), byIntervals(intervalSlots, 0);
+    for (std::uint32_t i = 0; i < entries.size(); ++i) {
+        std::uint32_t slot = entries[i].nameHash & (nameSlots - 1);
+        while (byName[slot]) slot = (slot + 1) & (nameSlots - 1);
+        byName[slot] = i + 1;
+
+        const Entry& e = entries[i];
+        bool duplicate = false;
+        slot = e.intervalHash & (intervalSlots - 1);
+        for (; byIntervals[slot]; slot = (slot + 1) & (intervalSlots - 1)) {
+            const Entry& other = entries[byIntervals[slot] - 1];
+            if (other.intervalHash == e.intervalHash && other.count == e.count
+                && std::equal(ints.begin() + e.normalized, ints.begin() + e.normalized + e.count,
+                              ints.begin() + other.normalized)) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) byIntervals[slot] = i + 1;
+    }
+
+    Header header{{'C', 'Y', 'Q', 'S'}, SNAPSHOT_VERSION,
+                  static_cast<std::uint32_t>(entries.size()), nameSlots, intervalSlots,
+                  static_cast<std::uint32_t>(ints.size()), static_cast<std::uint32_t>(names.size()), 0};
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    out.write(reinterpret_cast<const char*>(byName.data()), byName.size() * sizeof(std::uint32_t));
+    out.write(reinterpret_cast<const char*>(byIntervals.data()), byIntervals.size() * sizeof(std::uint32_t));
+    out.write(reinterpret_cast<const char*>(ints.data()), ints.size() * sizeof(std::int32_t));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+    if (!out) {
+        throw std::runtime_error("Cannot write quality snapshot: " + path);
+    }
+}
+
+std::shared_ptr<const QualitySnapshot> QualitySnapshot::open(const std::string& path) {
+    return std::shared_ptr<const QualitySnapshot>(new QualitySnapshot(MappedFile(path)));
+}
+
+QualitySnapshot::QualitySnapshot(MappedFile file)
+    : m_file(std::move(file))
+{
+    const char* data = m_file.data();
+    const std::size_t size = m_file.size();
+    auto corrupt = [] { return std::runtime_error("Not a valid quality snapshot."); };
+    if (size < sizeof(Header)) {
+        throw corrupt();
+    }
+    m_header = reinterpret_cast<const Header*>(data);
+    const Header& h = *m_header;
+    if (std::memcmp(h.magic, "CYQS", 4) != 0 || h.version != SNAPSHOT_VERSION
+        || h.nameSlots == 0 || (h.nameSlots & (h.nameSlots - 1)) != 0 || h.nameSlots <= h.entryCount
+        || h.intervalSlots == 0 || (h.intervalSlots & (h.intervalSlots - 1)) != 0 || h.intervalSlots <= h.entryCount) {
+        throw corrupt();
+    }
+    const std::size_t expected = sizeof(Header) + std::size_t(h.entryCount) * sizeof(Entry)
+                               + (std::size_t(h.nameSlots) + h.intervalSlots) * sizeof(std::uint32_t)
+                               + std::size_t(h.intCount) * sizeof(std::int32_t) + h.nameBytes;
+    if (size < expected) {
+        throw corrupt();
+    }
+    m_entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+    m_nameSlots = reinterpret_cast<const std::uint32_t*>(m_entries + h.entryCount);
+    m_intervalSlots = m_nameSlots + h.nameSlots;
+    m_ints = reinterpret_cast<const std::int32_t*>(m_intervalSlots + h.intervalSlots);
+    m_names = reinterpret_cast<const char*>(m_ints + h.intCount);
+
+    for (std::uint32_t i = 0; i < h.entryCount; ++i) {
+        const Entry& e = m_entries[i];
+        const std::uint64_t rows = e.count ? e.count - 1 : 0;
+        if (std::uint64_t(e.nameOffset) + e.nameLength > h.nameBytes
+            || std::uint64_t(e.intervals) + e.count > h.intCount
+            || std::uint64_t(e.normalized) + e.count > h.intCount
+            || std::uint64_t(e.inversions) + rows * e.count > h.intCount) {
+            throw corrupt();
+        }
+    }
+    for (std::uint32_t i = 0; i < h.nameSlots + h.intervalSlots; ++i) {
+        if (m_nameSlots[i] > h.entryCount) {
+            throw corrupt();
+        }
+    }
+}
+
+std::size_t QualitySnapshot::size() const {
+    return m_header->entryCount;
+}
+
+long QualitySnapshot::find(std::string_view name) const {
+    const std::uint32_t hash = hashName(name);
+    const std::uint32_t mask = m_header->nameSlots - 1;
+    for (std::uint32_t slot = hash & mask, probes = 0; probes <= mask; slot = (slot + 1) & mask, ++probes) {
+        const std::uint32_t v = m_nameSlots[slot];
+        if (v == 0) {
+            return -1;
+        }
+        if (m_entries[v - 1].nameHash == hash && this->name(v - 1) == name) {
+            return static_cast<long>(v - 1);
+        }
+    }
+    return -1;
+}
+
+long QualitySnapshot::findByIntervals(const std::vector<int>& normalized) const {
+    std::vector<std::int32_t> key(normalized.begin(), normalized.end());
+    const std::uint32_t hash = hashIntervals(key.data(), key.size());
+    const std::uint32_t mask = m_header->intervalSlots - 1;
+    for (std::uint32_t slot = hash & mask, probes = 0; probes <= mask; slot = (slot + 1) & mask, ++probes) {
+        const std::uint32_t v = m_intervalSlots[slot];
+        if (v == 0) {
+            return -1;
+        }
+        const Entry& e = m_entries[v - 1];
+        if (e.intervalHash == hash && e.count == key.size()
+            && std::equal(key.begin(), key.end(), m_ints + e.normalized)) {
+            return static_cast<long>(v - 1);
+        }
+    }
+    return -1;
+}
+
+std::string_view QualitySnapshot::name(std::size_t entry) const {
+    const Entry& e = m_entries[entry];
+    return std::string_view(m_names + e.nameOffset, e.nameLength);
+}
+
+QualitySnapshot::Intervals QualitySnapshot::intervals(std::size_t entry) const {
+    const Entry& e = m_entries[entry];
+    return Intervals{m_ints + e.intervals, e.count};
+}
+
+QualitySnapshot::Intervals QualitySnapshot::normalized(std::size_t entry) const {
+    const Entry& e = m_entries[entry];
+    return Intervals{m_ints + e.normalized, e.count};
+}
+
+QualitySnapshot::Intervals QualitySnapshot::inversion(std::size_t entry, int inversion) const {
+    const Entry& e = m_entries[entry];
+    if (inversion < 1 || static_cast<std::uint32_t>(inversion) >= e.count) {
+        throw std::runtime_error("Inversion out of range in QualitySnapshot.");
+    }
+    return Intervals{m_ints + e.inversions + std::size_t(inversion - 1) * e.count, e.count};
+}
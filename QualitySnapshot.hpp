@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.hpp"
+
+/**
+ * Precompiled, memory-mapped quality dictionary, used by QualityManager to
+ * serve a registry straight from a file without building its maps.
+ *
+ * The file holds every quality sorted by name with its raw intervals, the
+ * normalized (sorted, 0-based) intervals, and the intervals of inversions
+ * 1..n-1, plus open-addressing hash tables by name and by normalized
+ * intervals. Byte order is the host's.
+ */
+class QualitySnapshot {
+public:
+    // Write a snapshot of 'qualities' (name => raw intervals)
+    static void write(const std::string& path, const std::map<std::string, std::vector<int>>& qualities);
+
+    // Map a snapshot file; throws std::runtime_error if it is not a valid snapshot
+    static std::shared_ptr<const QualitySnapshot> open(const std::string& path);
+
+    struct Intervals {
+        const std::int32_t* data;
+        std::size_t size;
+        std::vector<int> toVector() const { return std::vector<int>(data, data + size); }
+    };
+
+    std::size_t size() const;  // entries are in name order
+
+    // Entry index, or -1
+    long find(std::string_view name) const;
+    // First entry (in name order) with these normalized intervals, or -1
+    long findByIntervals(const std::vector<int>& normalized) const;
+
+    std::string_view name(std::size_t entry) const;
+    Intervals intervals(std::size_t entry) const;
+    Intervals normalized(std::size_t entry) const;
+    // Intervals after 'inversion' rotations, for 1 <= inversion < intervals(entry).size
+    Intervals inversion(std::size_t entry, int inversion) const;
+
+private:
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t nameSlots;      // power of two
+        std::uint32_t intervalSlots;  // power of two
+        std::uint32_t intCount;
+        std::uint32_t nameBytes;
+        std::uint32_t reserved;
+    };
+    struct Entry {
+        std::uint32_t nameOffset;
+        std::uint32_t nameLength;
+        std::uint32_t intervals;      // offset into the int pool
+        std::uint32_t count;
+        std::uint32_t normalized;
+        std::uint32_t inversions;     // (count - 1) rows of 'count' ints
+        std::uint32_t nameHash;
+        std::uint32_t intervalHash;
+    };
+
+    explicit QualitySnapshot(MappedFile file);
+
+    static std::uint32_t hashName(std::string_view name);
+    static std::uint32_t hashIntervals(const std::int32_t* data, std::size_t size);
+
+    MappedFile m_file;
+    const Header* m_header;
+    const Entry* m_entries;
+    const std::uint32_t* m_nameSlots;      // entry + 1, 0 = empty
+    const std::uint32_t* m_intervalSlots;
+    const std::int32_t* m_ints;
+    const char* m_names;
+};
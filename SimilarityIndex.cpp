@@ -0,0 +1,353 @@
+#include "SimilarityIndex.hpp"
+#include "Parallel.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+// Interval-class vector (counts of ic1..ic6) for every 12-bit pitch-class set
+static const std::array<std::array<std::uint8_t, 6>, 4096>& intervalVectors() {
+    static const auto table = [] {
+        std::array<std::array<std::uint8_t, 6>, 4096> t{};
+        for (unsigned mask = 0; mask < 4096; ++mask) {
+            for (int a = 0; a < 12; ++a) {
+                if (!(mask & (1u << a))) continue;
+                for (int b = a + 1; b < 12; ++b) {
+                    if (!(mask & (1u << b))) continue;
+                    int ic = std::min(b - a, 12 - (b - a));
+                    ++t[mask][ic - 1];
+                }
+            }
+        }
+        return t;
+    }();
+    return table;
+}
+
+static unsigned maskOf(const std::vector<int>& midiNotes) {
+    unsigned mask = 0;
+    for (int note : midiNotes) {
+        mask |= 1u << (((note % 12) + 12) % 12);
+    }
+    return mask;
+}
+
+// Largest distance from any note of 'a' to its nearest note in 'b'
+static int directedMove(const int* a, std::size_t na, const int* b, std::size_t nb) {
+    int worst = 0;
+    for (std::size_t i = 0; i < na; ++i) {
+        int best = std::abs(a[i] - b[0]);
+        for (std::size_t j = 1; j < nb; ++j) {
+            best = std::min(best, std::abs(a[i] - b[j]));
+        }
+        worst = std::max(worst, best);
+    }
+    return worst;
+}
+
+SimilarityIndex::SimilarityIndex(ChordDistance metric)
+    : m_metric(metric), m_offsets(1, 0)
+{
+}
+
+std::size_t SimilarityIndex::add(const Chord& chord, int rootOctave) {
+    int notes[Chord::MAX_COMPONENTS];
+    std::size_t n = chord.pitches(rootOctave, notes, Chord::MAX_COMPONENTS);
+    return add(std::vector<int>(notes, notes + n));
+}
+
+std::size_t SimilarityIndex::add(const std::vector<int>& midiNotes) {
+    if (midiNotes.empty()) {
+        throw std::runtime_error("Cannot add an empty voicing to SimilarityIndex.");
+    }
+    m_masks.push_back(static_cast<std::uint16_t>(maskOf(midiNotes)));
+    m_notes.insert(m_notes.end(), midiNotes.begin(), midiNotes.end());
+    m_offsets.push_back(static_cast<std::uint32_t>(m_notes.size()));
+    m_built = false;
+    return m_masks.size() - 1;
+}
+
+SimilarityIndex::Point SimilarityIndex::point(std::size_t id) const {
+    return Point{m_masks[id], m_notes.data() + m_offsets[id], m_offsets[id + 1] - m_offsets[id]};
+}
+
+int SimilarityIndex::distance(const Point& a, const Point& b) const {
+    switch (m_metric) {
+    case ChordDistance::Hamming:
+        return popcount12(a.mask ^ b.mask);
+    case ChordDistance::IntervalVector: {
+        const auto& va = intervalVectors()[a.mask];
+        const auto& vb = intervalVectors()[b.mask];
+        int d = 0;
+        for (int i = 0; i < 6; ++i) {
+            d += std::abs(va[i] - vb[i]);
+        }
+        return d;
+    }
+    case ChordDistance::VoiceLeading:
+        return std::max(directedMove(a.notes, a.count, b.notes, b.count),
+                        directedMove(b.notes, b.count, a.notes, a.count));
+    }
+    return 0;
+}
+
+int SimilarityIndex::distance(std::size_t a, std::size_t b) const {
+    if (a >= size() || b >= size()) {
+        throw std::runtime_error("Index out of range in SimilarityIndex::distance.");
+    }
+    return distance(point(a), point(b));
+}
+
+std::uint32_t SimilarityIndex::buildNode(std::vector<std::uint32_t>& ids, Tree& tree) const {
+    const std::uint32_t pivot = ids[0];
+    const Point p = point(pivot);
+    std::vector<std::pair<int, std::uint32_t>> byDistance;
+    byDistance.reserve(ids.size() - 1);
+    for (std::size_t i = 1; i < ids.size(); ++i) {
+        byDistance.emplace_back(distance(p, point(ids[i])), ids[i]);
+    }
+    std::vector<std::uint32_t>().swap(ids);
+    std::sort(byDistance.begin(), byDistance.end());
+
+    const std::uint32_t index = static_cast<std::uint32_t>(tree.nodes.size());
+    tree.nodes.push_back(Node{});
+    tree.nodes[index].memberBegin = static_cast<std::uint32_t>(tree.members.size());
+    tree.members.push_back(pivot);
+    std::size_t i = 0;
+    for (; i < byDistance.size() && byDistance[i].first == 0; ++i) {
+        tree.members.push_back(byDistance[i].second);
+    }
+    tree.nodes[index].memberEnd = static_cast<std::uint32_t>(tree.members.size());
+
+    std::vector<Edge> edges;
+    while (i < byDistance.size()) {
+        const int d = byDistance[i].first;
+        std::vector<std::uint32_t> group;
+        for (; i < byDistance.size() && byDistance[i].first == d; ++i) {
+            group.push_back(byDistance[i].second);
+        }
+        edges.push_back(Edge{d, buildNode(group, tree)});
+    }
+    tree.nodes[index].edgeBegin = static_cast<std::uint32_t>(tree.edges.size());
+    tree.edges.insert(tree.edges.end(), edges.begin(), edges.end());
+    tree.nodes[index].edgeEnd = static_cast<std::uint32_t>(tree.edges.size());
+    return index;
+}
+
+void SimilarityIndex::splice(const Tree& subtree, std::uint32_t& root) {
+    const auto nodeOffset = static_cast<std::uint32_t>(m_tree.nodes.size());
+    const auto edgeOffset = static_cast<std::uint32_t>(m_tree.edges.size());
+    const auto memberOffset = static_cast<std::uint32_t>(m_tree.members.size());
+    for (Node node : subtree.nodes) {
+        node.memberBegin += memberOffset;
+        node.memberEnd += memberOffset;
+        node.edgeBegin += edgeOffset;
+        node.edgeEnd += edgeOffset;
+        m_tree.nodes.push_back(node);
+    }
+    for (Edge edge : subtree.edges) {
+        edge.child += nodeOffset;
+        m_tree.edges.push_back(edge);
+    }
+    m_tree.members.insert(m_tree.members.end(), subtree.members.begin(), subtree.members.end());
+    root += nodeOffset;
+}
+
+void SimilarityIndex::build(unsigned threads) {
+    m_tree = Tree();
+    m_built = true;
+    const std::size_t n = size();
+    if (n == 0) {
+        return;
+    }
+
+    // Root level: distances to the pivot in parallel chunks
+    const Point pivot = point(0);
+    std::vector<int> rootDistance(n, 0);
+    const std::size_t chunk = 4096;
+    parallelFor((n + chunk - 1) / chunk, threads, [&](std::size_t c) {
+        const std::size_t end = std::min(n, (c + 1) * chunk);
+        for (std::size_t i = std::max<std::size_t>(1, c * chunk); i < end; ++i) {
+            rootDistance[i] = distance(pivot, point(i));
+        }
+    });
+
+    // One bucket per distinct distance; each becomes an independent subtree
+    std::vector<int> distances(rootDistance.begin() + 1, rootDistance.end());
+    std::sort(distances.begin(), distances.end());
+    distances.erase(std::unique(distances.begin(), distances.end()), distances.end());
+    std::vector<std::vector<std::uint32_t>> buckets(distances.size());
+    for (std::size_t i = 1; i < n; ++i) {
+        auto pos = std::lower_bound(distances.begin(), distances.end(), rootDistance[i]) - distances.begin();
+        buckets[pos].push_back(static_cast<std::uint32_t>(i));
+    }
+
+    m_tree.nodes.push_back(Node{});
+    m_tree.members.push_back(0);
+    std::size_t first = 0;
+    if (!distances.empty() && distances[0] == 0) {
+        m_tree.members.insert(m_tree.members.end(), buckets[0].begin(), buckets[0].end());
+        first = 1;
+    }
+    m_tree.nodes[0].memberBegin = 0;
+    m_tree.nodes[0].memberEnd = static_cast<std::uint32_t>(m_tree.members.size());
+
+    std::vector<Tree> subtrees(buckets.size());
+    std::vector<std::uint32_t> roots(buckets.size(), 0);
+    parallelFor(buckets.size() - first, threads, [&](std::size_t b) {
+        b += first;
+        roots[b] = buildNode(buckets[b], subtrees[b]);
+    });
+
+    std::vector<Edge> edges;
+    for (std::size_t b = first; b < buckets.size(); ++b) {
+        splice(subtrees[b], roots[b]);
+        subtrees[b] = Tree();
+        edges.push_back(Edge{distances[b], roots[b]});
+    }
+    m_tree.nodes[0].edgeBegin = static_cast<std::uint32_t>(m_tree.edges.size());
+    m_tree.edges.insert(m_tree.edges.end(), edges.begin(), edges.end());
+    m_tree.nodes[0].edgeEnd = static_cast<std::uint32_t>(m_tree.edges.size());
+}
+
+bool SimilarityIndex::isBuilt() const {
+    return m_built;
+}
+
+// Results are the k smallest (distance, id) pairs, so ties resolve to the earliest entry
+std::vector<Neighbour> SimilarityIndex::search(const Point& query, std::size_t k) const {
+    using Candidate = std::pair<int, std::size_t>;
+    std::priority_queue<Candidate> best;  // worst kept candidate on top
+    auto bound = [&]() {
+        return best.size() < k ? std::numeric_limits<int>::max() : best.top().first;
+    };
+
+    std::vector<std::pair<std::uint32_t, int>> stack;  // node, lower bound on its distances
+    stack.emplace_back(0, 0);
+    while (!stack.empty()) {
+        auto [index, lower] = stack.back();
+        stack.pop_back();
+        if (lower > bound()) continue;
+
+        const Node& node = m_tree.nodes[index];
+        const int d = distance(query, point(m_tree.members[node.memberBegin]));
+        for (std::uint32_t m = node.memberBegin; m < node.memberEnd; ++m) {
+            Candidate c(d, m_tree.members[m]);
+            if (best.size() < k) {
+                best.push(c);
+            } else if (c < best.top()) {
+                best.pop();
+                best.push(c);
+            }
+        }
+        for (std::uint32_t e = node.edgeBegin; e < node.edgeEnd; ++e) {
+            const int gap = std::abs(m_tree.edges[e].distance - d);
+            if (gap <= bound()) {
+                stack.emplace_back(m_tree.edges[e].child, gap);
+            }
+        }
+    }
+
+    std::vector<Neighbour> result(best.size());
+    for (std::size_t i = result.size(); i-- > 0; best.pop()) {
+        result[i] = Neighbour{best.top().second, best.top().first};
+    }
+    return result;
+}
+
+std::vector<Neighbour> SimilarityIndex::scan(const Point& query, std::size_t k) const {
+    const std::size_t n = size();
+    const std::size_t want = std::min(k, n);
+    std::vector<Neighbour> result;
+    result.reserve(want);
+    if (want == 0) {
+        return result;
+    }
+
+    if (m_metric == ChordDistance::Hamming) {
+        // Histogram pass over the packed masks finds the cutoff distance, a second pass collects
+        std::size_t histogram[13] = {};
+        const std::uint16_t* masks = m_masks.data();
+        const unsigned q = query.mask;
+        for (std::size_t i = 0; i < n; ++i) {
+            ++histogram[popcount12(masks[i] ^ q)];
+        }
+        int cutoff = 0;
+        std::size_t below = 0;
+        while (below + histogram[cutoff] < want) {
+            below += histogram[cutoff++];
+        }
+        std::size_t atCutoff = want - below;
+        for (std::size_t i = 0; i < n; ++i) {
+            const int d = popcount12(masks[i] ^ q);
+            if (d < cutoff || (d == cutoff && atCutoff > 0 && atCutoff--)) {
+                result.push_back(Neighbour{i, d});
+            }
+        }
+    } else {
+        std::vector<std::pair<int, std::size_t>> all(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            all[i] = {distance(query, point(i)), i};
+        }
+        std::partial_sort(all.begin(), all.begin() + want, all.end());
+        for (std::size_t i = 0; i < want; ++i) {
+            result.push_back(Neighbour{all[i].second, all[i].first});
+        }
+        return result;
+    }
+
+    std::sort(result.begin(), result.end(), [](const Neighbour& a, const Neighbour& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.id < b.id;
+    });
+    return result;
+}
+
+std::vector<Neighbour> SimilarityIndex::nearest(const Chord& chord, std::size_t k, int rootOctave) const {
+    int notes[Chord::MAX_COMPONENTS];
+    std::size_t n = chord.pitches(rootOctave, notes, Chord::MAX_COMPONENTS);
+    return nearest(std::vector<int>(notes, notes + n), k);
+}
+
+std::vector<Neighbour> SimilarityIndex::nearest(const std::vector<int>& midiNotes, std::size_t k) const {
+    if (midiNotes.empty()) {
+        throw std::runtime_error("Empty query voicing in SimilarityIndex::nearest.");
+    }
+    Point query{maskOf(midiNotes), midiNotes.data(), midiNotes.size()};
+    if (!m_built || k == 0 || size() == 0) {
+        return scan(query, k);
+    }
+    return search(query, k);
+}
+
+std::vector<Neighbour> SimilarityIndex::nearestBruteForce(const std::vector<int>& midiNotes, std::size_t k) const {
+    if (midiNotes.empty()) {
+        throw std::runtime_error("Empty query voicing in SimilarityIndex::nearestBruteForce.");
+    }
+    return scan(Point{maskOf(midiNotes), midiNotes.data(), midiNotes.size()}, k);
+}
+
+std::size_t SimilarityIndex::size() const {
+    return m_masks.size();
+}
+
+ChordDistance SimilarityIndex::metric() const {
+    return m_metric;
+}
+
+unsigned SimilarityIndex::pitchClassMask(std::size_t id) const {
+    if (id >= size()) {
+        throw std::runtime_error("Index out of range in SimilarityIndex::pitchClassMask.");
+    }
+    return m_masks[id];
+}
+
+std::vector<int> SimilarityIndex::voicing(std::size_t id) const {
+    if (id >= size()) {
+        throw std::runtime_error("Index out of range in SimilarityIndex::voicing.");
+    }
+    return std::vector<int>(m_notes.begin() + m_offsets[id], m_notes.begin() + m_offsets[id + 1]);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Chord.hpp"
+
+/**
+ * k-nearest-neighbour search over a corpus of chords and voicings.
+ *
+ * Entries are stored flat (a 12-bit pitch-class mask plus the MIDI notes of
+ * the voicing). build() organizes them into a BK-tree for the chosen metric;
+ * entries at distance 0 from a node share it, so a corpus of millions of
+ * voicings over a few thousand distinct pitch-class sets stays small. Until
+ * build() is called (and after any add()) queries fall back to a linear scan.
+ */
+
+enum class ChordDistance {
+    Hamming,        // pitch classes in one set but not the other
+    IntervalVector, // L1 distance between interval-class vectors
+    VoiceLeading    // largest move any note needs to reach the other voicing (semitones)
+};
+
+struct Neighbour {
+    std::size_t id;  // insertion index returned by add()
+    int distance;
+};
+
+class SimilarityIndex {
+public:
+    explicit SimilarityIndex(ChordDistance metric = ChordDistance::Hamming);
+
+    // Add an entry and return its id; invalidates a built tree
+    std::size_t add(const Chord& chord, int rootOctave = 4);
+    std::size_t add(const std::vector<int>& midiNotes);
+
+    /**
+     * Build the BK-tree. Distances to the root pivot and the subtrees below
+     * it are computed on up to 'threads' workers (0 = hardware concurrency).
+     */
+    void build(unsigned threads = 0);
+    bool isBuilt() const;
+
+    // The k closest entries, ordered by (distance, id)
+    std::vector<Neighbour> nearest(const Chord& chord, std::size_t k, int rootOctave = 4) const;
+    std::vector<Neighbour> nearest(const std::vector<int>& midiNotes, std::size_t k) const;
+
+    // Same result as nearest(), always by linear scan
+    std::vector<Neighbour> nearestBruteForce(const std::vector<int>& midiNotes, std::size_t k) const;
+
+    int distance(std::size_t a, std::size_t b) const;
+    std::size_t size() const;
+    ChordDistance metric() const;
+    unsigned pitchClassMask(std::size_t id) const;
+    std::vector<int> voicing(std::size_t id) const;
+
+private:
+    struct Point {
+        unsigned mask;
+        const int* notes;
+        std::size_t count;
+    };
+    struct Node {
+        std::uint32_t memberBegin, memberEnd;  // ids at distance 0, pivot first
+        std::uint32_t edgeBegin, edgeEnd;
+    };
+    struct Edge {
+        int distance;
+        std::uint32_t child;
+    };
+    struct Tree {
+        std::vector<Node> nodes;
+        std::vector<Edge> edges;
+        std::vector<std::uint32_t> members;
+    };
+
+    Point point(std::size_t id) const;
+    int distance(const Point& a, const Point& b) const;
+    std::uint32_t buildNode(std::vector<std::uint32_t>& ids, Tree& tree) const;
+    void splice(const Tree& subtree, std::uint32_t& root);
+    std::vector<Neighbour> search(const Point& query, std::size_t k) const;
+    std::vector<Neighbour> scan(const Point& query, std::size_t k) const;
+
+    ChordDistance m_metric;
+    std::vector<std::uint16_t> m_masks;
+    std::vector<std::uint32_t> m_offsets;  // notes of entry i: [m_offsets[i], m_offsets[i + 1])
+    std::vector<int> m_notes;
+    Tree m_tree;
+    bool m_built = false;
+};
@@ -0,0 +1,341 @@
+#include "Spelling.hpp"
+#include "Constants.hpp"
+#include "Diatonic.hpp"
+#include "Parallel.hpp"
+#include "Utils.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+static const int NATURAL_PC[7] = {0, 2, 4, 5, 7, 9, 11};
+static const char LETTERS[] = "CDEFGAB";
+
+static int wrapAccidental(int semitones) {
+    // Difference of two pitch classes as -6..5
+    semitones = ((semitones % 12) + 12) % 12;
+    return semitones > 5 ? semitones - 12 : semitones;
+}
+
+static int pitchClassOf(SpelledNote note) {
+    return ((NATURAL_PC[note.letter] + note.accidental) % 12 + 12) % 12;
+}
+
+/**
+ * Degree (0 = root .. 6 = seventh) of each interval 0..11 for every chord
+ * shape, keyed by the 12-bit root-relative mask.
+ */
+static int chordDegree(unsigned mask, int interval) {
+    auto has = [&](int i) { return (mask >> i) & 1u; };
+    switch (interval) {
+    case 0: return 0;
+    case 1: case 2: return 1;
+    case 3: return has(4) ? 1 : 2;                 // #9 next to a major third
+    case 4: return 2;
+    case 5: return 3;
+    case 6: return has(7) ? 3 : 4;                 // #11 next to a perfect fifth
+    case 7: return 4;
+    case 8: return has(7) ? 5 : 4;                 // b13 next to a perfect fifth
+    case 9: return (has(3) && has(6) && !has(7) && !has(10) && !has(11)) ? 6 : 5; // bb7 in dim7
+    default: return 6;
+    }
+}
+
+struct SpellingTables {
+    std::string names[7][5];                  // [letter][accidental + 2]
+    std::uint8_t degrees[4096][12];           // chordDegree() for every mask
+    const std::string* tones[7][7][12];       // [root letter][degree][pitch class]
+    SpelledNote tonics[12][7];                // default tonic per [key root][mode]
+    // Per key, indexed by the tonic's spelling: [letter][accidental + 1][mode][pitch class]
+    SpelledNote inKey[7][3][7][12];
+    std::uint8_t keyDegrees[7][3][7][12];     // scale degree 1..7 of the letter used
+
+    SpellingTables() {
+        static const char* ACCIDENTALS[5] = {"bb", "b", "", "#", "##"};
+        for (int letter = 0; letter < 7; ++letter) {
+            for (int a = 0; a < 5; ++a) {
+                names[letter][a] = std::string(1, LETTERS[letter]) + ACCIDENTALS[a];
+            }
+        }
+
+        for (unsigned mask = 0; mask < 4096; ++mask) {
+            for (int interval = 0; interval < 12; ++interval) {
+                degrees[mask][interval] = static_cast<std::uint8_t>(chordDegree(mask, interval));
+            }
+        }
+
+        for (int letter = 0; letter < 7; ++letter) {
+            for (int degree = 0; degree < 7; ++degree) {
+                for (int pc = 0; pc < 12; ++pc) {
+                    tones[letter][degree][pc] = &name(toneSpelling(letter, degree, pc));
+                }
+            }
+        }
+
+        for (int mode = 0; mode < 7; ++mode) {
+            const auto& pattern = RELATIVE_KEY_DICT.at(MODE_NAMES[mode]);
+            for (int root = 0; root < 12; ++root) {
+                tonics[root][mode] = defaultTonic(root, pattern);
+            }
+            for (int letter = 0; letter < 7; ++letter) {
+                for (int a = -1; a <= 1; ++a) {
+                    buildKey(SpelledNote{letter, a}, mode, pattern);
+                }
+            }
+            // Keys like B#maj need double accidentals; use the enharmonic key's names there
+            for (int letter = 0; letter < 7; ++letter) {
+                for (int a = -1; a <= 1; ++a) {
+                    const SpelledNote tonic = tonics[pitchClassOf(SpelledNote{letter, a})][mode];
+                    for (int pc = 0; pc < 12; ++pc) {
+                        if (std::abs(inKey[letter][a + 1][mode][pc].accidental) > 1) {
+                            inKey[letter][a + 1][mode][pc] = inKey[tonic.letter][tonic.accidental + 1][mode][pc];
+                            keyDegrees[letter][a + 1][mode][pc] = keyDegrees[tonic.letter][tonic.accidental + 1][mode][pc];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const std::string& name(SpelledNote note) const {
+        return names[note.letter][note.accidental + 2];
+    }
+
+    // 'pc' spelled on the letter 'degree' steps above 'letter'; nearest single spelling if that needs a triple
+    static SpelledNote toneSpelling(int letter, int degree, int pc) {
+        SpelledNote tone{(letter + degree) % 7, 0};
+        tone.accidental = wrapAccidental(pc - NATURAL_PC[tone.letter]);
+        if (std::abs(tone.accidental) <= 2) return tone;
+        for (int l = 0; l < 7; ++l) {
+            const int a = wrapAccidental(pc - NATURAL_PC[l]);
+            if (a == 0 || a == -1) return SpelledNote{l, a};
+        }
+        return SpelledNote{0, 0}; // unreachable: every pitch class is a natural or a flat
+    }
+
+    // Tonic spelling with the fewest accidentals in the scale, all single; flats on ties
+    static SpelledNote defaultTonic(int root, const std::vector<int>& pattern) {
+        SpelledNote best{0, 0};
+        int bestCost = 1000;
+        for (int letter = 0; letter < 7; ++letter) {
+            const int a = wrapAccidental(root - NATURAL_PC[letter]);
+            if (std::abs(a) > 1) continue;
+            int cost = 0;
+            for (int d = 0; d < 7; ++d) {
+                const int acc = wrapAccidental(root + pattern[d] - NATURAL_PC[(letter + d) % 7]);
+                cost += std::abs(acc) > 1 ? 100 : std::abs(acc);
+            }
+            if (cost < bestCost || (cost == bestCost && a < best.accidental)) {
+                best = SpelledNote{letter, a};
+                bestCost = cost;
+            }
+        }
+        return best;
+    }
+
+    void buildKey(SpelledNote tonic, int mode, const std::vector<int>& pattern) {
+        SpelledNote* names = inKey[tonic.letter][tonic.accidental + 1][mode];
+        std::uint8_t* degreesOf = keyDegrees[tonic.letter][tonic.accidental + 1][mode];
+        const int root = pitchClassOf(tonic);
+
+        SpelledNote scale[7];
+        int signature = 0;
+        for (int d = 0; d < 7; ++d) {
+            scale[d].letter = (tonic.letter + d) % 7;
+            scale[d].accidental = wrapAccidental(root + pattern[d] - NATURAL_PC[scale[d].letter]);
+            signature += scale[d].accidental;
+        }
+
+        for (int pc = 0; pc < 12; ++pc) {
+            int degree = -1;
+            for (int d = 0; d < 7; ++d) {
+                if (pitchClassOf(scale[d]) == pc) degree = d;
+            }
+            if (degree >= 0) {
+                names[pc] = scale[degree];
+                degreesOf[pc] = static_cast<std::uint8_t>(degree + 1);
+                continue;
+            }
+            /**
+             * Raise the degree below or lower the one above. The candidate with
+             * fewer accidentals wins (C, not B#, in D major); between two single
+             * accidentals, follow the key signature (flats without one, except F#).
+             */
+            int raised = 0, lowered = 0;
+            for (int d = 0; d < 7; ++d) {
+                if (pitchClassOf(scale[d]) == (pc + 11) % 12) raised = d;
+                if (pitchClassOf(scale[d]) == (pc + 1) % 12) lowered = d;
+            }
+            const SpelledNote up{scale[raised].letter, scale[raised].accidental + 1};
+            const SpelledNote down{scale[lowered].letter, scale[lowered].accidental - 1};
+            bool useRaised;
+            if (std::abs(up.accidental) != std::abs(down.accidental)) {
+                useRaised = std::abs(up.accidental) < std::abs(down.accidental);
+            } else if (signature != 0) {
+                useRaised = signature > 0;
+            } else {
+                useRaised = pc == 6;
+            }
+            names[pc] = useRaised ? up : down;
+            degreesOf[pc] = static_cast<std::uint8_t>((useRaised ? raised : lowered) + 1);
+        }
+    }
+};
+
+static const SpellingTables& tables() {
+    static const SpellingTables instance;
+    return instance;
+}
+
+static void checkMode(int mode) {
+    if (mode < 0 || mode >= 7) {
+        throw std::runtime_error("Invalid mode index.");
+    }
+}
+
+// The default tonic spelling of a key given by pitch class
+static SpelledNote defaultTonic(int keyRoot, int mode) {
+    checkMode(mode);
+    return tables().tonics[((keyRoot % 12) + 12) % 12][mode];
+}
+
+SpelledNote parseSpelledNote(std::string_view name) {
+    if (name.empty() || name.size() > 3 || name[0] < 'A' || name[0] > 'G') {
+        throw std::runtime_error("Unknown note: " + std::string(name));
+    }
+    SpelledNote note{(name[0] - 'C' + 7) % 7, 0};
+    for (std::size_t i = 1; i < name.size(); ++i) {
+        if (name[i] == '#' && note.accidental >= 0) {
+            ++note.accidental;
+        } else if (name[i] == 'b' && note.accidental <= 0) {
+            --note.accidental;
+        } else {
+            throw std::runtime_error("Unknown note: " + std::string(name));
+        }
+    }
+    return note;
+}
+
+const std::string& spelledNoteName(SpelledNote note) {
+    if (note.letter < 0 || note.letter > 6 || note.accidental < -2 || note.accidental > 2) {
+        throw std::runtime_error("Invalid spelled note.");
+    }
+    return tables().name(note);
+}
+
+const std::string& keyTonicName(int keyRoot, int mode) {
+    return tables().name(defaultTonic(keyRoot, mode));
+}
+
+const std::string& spellInKey(int pitchClass, SpelledNote tonic, int mode) {
+    checkMode(mode);
+    if (tonic.letter < 0 || tonic.letter > 6 || std::abs(tonic.accidental) > 2) {
+        throw std::runtime_error("Invalid spelled note.");
+    }
+    if (std::abs(tonic.accidental) > 1) {
+        tonic = defaultTonic(pitchClassOf(tonic), mode);
+    }
+    const SpellingTables& t = tables();
+    return t.name(t.inKey[tonic.letter][tonic.accidental + 1][mode][((pitchClass % 12) + 12) % 12]);
+}
+
+const std::string& spellInKey(int pitchClass, int keyRoot, int mode) {
+    return spellInKey(pitchClass, defaultTonic(keyRoot, mode), mode);
+}
+
+int degreeInKey(int pitchClass, int keyRoot, int mode) {
+    const SpelledNote tonic = defaultTonic(keyRoot, mode);
+    return tables().keyDegrees[tonic.letter][tonic.accidental + 1][mode][((pitchClass % 12) + 12) % 12];
+}
+
+const std::string& spellChordTone(SpelledNote root, unsigned relativeMask, int interval) {
+    const SpellingTables& t = tables();
+    interval = ((interval % 12) + 12) % 12;
+    const int degree = t.degrees[relativeMask & 0xFFFu][interval];
+    const int pc = (pitchClassOf(root) + interval) % 12;
+    return *t.tones[root.letter][degree][pc];
+}
+
+std::size_t spellChordTones(const Chord& chord, const std::string** out, std::size_t capacity) {
+    const auto& intervals = chord.quality()->getIntervals();
+    if (intervals.size() > capacity) {
+        throw std::runtime_error("Too many chord tones for the output buffer.");
+    }
+    const SpelledNote root = parseSpelledNote(chord.rootView());
+    unsigned mask = 0;
+    for (int interval : intervals) {
+        mask |= 1u << (((interval % 12) + 12) % 12);
+    }
+    for (std::size_t i = 0; i < intervals.size(); ++i) {
+        out[i] = &spellChordTone(root, mask, intervals[i]);
+    }
+    return intervals.size();
+}
+
+std::vector<std::string> spellChordTones(const Chord& chord) {
+    const std::string* tones[Chord::MAX_COMPONENTS];
+    const std::size_t n = spellChordTones(chord, tones, Chord::MAX_COMPONENTS);
+    std::vector<std::string> result;
+    result.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        result.push_back(*tones[i]);
+    }
+    return result;
+}
+
+// Rebuild 'chord' with new root and slash names
+static Chord withNames(const Chord& chord, const std::string& root, const std::string& on,
+                       const Chord::allocator_type& alloc) {
+    if (chord.appendedView().empty()) {
+        return Chord::fromParts(root, chord.quality()->getQualityName(), on, alloc);
+    }
+    // Appended notes only survive a re-parse of the full name
+    std::string name = root + chord.quality()->getQualityName();
+    for (const auto& app : chord.appendedView()) {
+        name.append(app.data(), app.size());
+    }
+    name += displayOn(on);
+    return Chord(name, alloc);
+}
+
+Chord respellChord(const Chord& chord, int keyRoot, int mode, const Chord::allocator_type& alloc) {
+    const std::string& root = spellInKey(noteToVal(chord.rootView()), keyRoot, mode);
+    const std::string_view on = chord.onView();
+    return withNames(chord, root, on.empty() ? std::string() : spellInKey(noteToVal(on), keyRoot, mode), alloc);
+}
+
+static void respellAll(ChordProgression& progression, int semitones, SpelledNote tonic, int mode) {
+    const Chord::allocator_type alloc = progression.get_allocator();
+    for (Chord& chord : progression.chords()) {
+        const std::string& root = spellInKey(noteToVal(chord.rootView()) + semitones, tonic, mode);
+        const std::string_view on = chord.onView();
+        chord = withNames(chord, root,
+                          on.empty() ? std::string() : spellInKey(noteToVal(on) + semitones, tonic, mode),
+                          alloc);
+    }
+}
+
+void respellProgression(ChordProgression& progression, const std::string& scale) {
+    std::string root;
+    int mode = 0;
+    parseScale(scale, root, mode);
+    respellAll(progression, 0, parseSpelledNote(root), mode);
+}
+
+void transposeInKey(ChordProgression& progression, int semitones, const std::string& targetScale) {
+    std::string root;
+    int mode = 0;
+    parseScale(targetScale, root, mode);
+    respellAll(progression, semitones, parseSpelledNote(root), mode);
+}
+
+void transposeInKeyBatch(std::vector<ChordProgression>& progressions, int semitones,
+                         const std::string& targetScale, unsigned threads) {
+    std::string root;
+    int mode = 0;
+    parseScale(targetScale, root, mode);
+    const SpelledNote tonic = parseSpelledNote(root);
+    tables(); // build once before the workers start
+    parallelFor(progressions.size(), threads, [&](std::size_t i) {
+        respellAll(progressions[i], semitones, tonic, mode);
+    });
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ChordProgression.hpp"
+
+/**
+ * Key-aware enharmonic spelling.
+ *
+ * valToNote only picks between the sharp and flat tables per scale root. Here
+ * every key (12 tonics x 7 modes, MODE_NAMES order) gets its own scale
+ * spelling with consecutive letters, so D major has F# and Gb major has Cb;
+ * chromatic notes are a raised or lowered scale degree following the key
+ * signature. Chord tones are spelled from the chord root's letter by the
+ * tone's degree (third, fifth, ...), so Abm is Ab Cb Eb and Cdim7 has Bbb.
+ *
+ * All tables are built once, on first use; lookups return references into them.
+ */
+
+struct SpelledNote {
+    int letter;       // 0..6 for C D E F G A B
+    int accidental;   // -2..2, flats negative
+};
+
+// Split a note name like "F#", "Bbb" or "E" into letter and accidental; throws if invalid
+SpelledNote parseSpelledNote(std::string_view name);
+// "C", "F#", "Bbb", ...
+const std::string& spelledNoteName(SpelledNote note);
+
+// Tonic name of the key at pitch class 'keyRoot' in 'mode': fewest accidentals, flats on ties
+const std::string& keyTonicName(int keyRoot, int mode);
+
+/**
+ * Pitch class spelled in a key. Scale notes come from the key signature,
+ * others are an altered neighbouring degree. At most one accidental, so the
+ * names are valid chord roots and slash notes.
+ */
+const std::string& spellInKey(int pitchClass, int keyRoot, int mode);
+// Same, for the key written with this tonic (F#maj and Gbmaj differ)
+const std::string& spellInKey(int pitchClass, SpelledNote tonic, int mode);
+// Scale degree (1..7) of the letter spellInKey() uses for 'pitchClass'
+int degreeInKey(int pitchClass, int keyRoot, int mode);
+
+/**
+ * The tone 'interval' semitones above a spelled chord root, named by its
+ * degree within the chord: 'relativeMask' (bit 0 = root) tells e.g. a minor
+ * third (3) from a #9 (3 next to a 4), or a b5 from a #11.
+ */
+const std::string& spellChordTone(SpelledNote root, unsigned relativeMask, int interval);
+
+/**
+ * Spelled tones of a chord in the order of its quality's intervals (the
+ * order of Chord::pitches()). Writes pointers into the tables, at most
+ * 'capacity'; returns the number of tones, throws if they do not fit.
+ */
+std::size_t spellChordTones(const Chord& chord, const std::string** out, std::size_t capacity);
+std::vector<std::string> spellChordTones(const Chord& chord);
+
+// Chord with root and slash note respelled for a key, e.g. "A#m" in Fmaj -> "Bbm"
+Chord respellChord(const Chord& chord, int keyRoot, int mode,
+                   const Chord::allocator_type& alloc = Chord::allocator_type());
+// Respell every chord of a progression for 'scale' (e.g. "Dmaj", "Ebmin")
+void respellProgression(ChordProgression& progression, const std::string& scale);
+
+/**
+ * Transpose by 'semitones' and spell roots and slash notes for 'targetScale'
+ * (its tonic as written) in one pass of table lookups (the batch form runs on 'threads' workers).
+ */
+void transposeInKey(ChordProgression& progression, int semitones, const std::string& targetScale);
+void transposeInKeyBatch(std::vector<ChordProgression>& progressions, int semitones,
+                         const std::string& targetScale, unsigned threads = 0);
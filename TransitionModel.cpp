@@ -0,0 +1,390 @@
+#include "TransitionModel.hpp"
+#include "Constants.hpp"
+#include "Parallel.hpp"
+#include "QualityManager.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+
+/**
+ * Keys: a context packs up to MAX_CONTEXT chords as 12-bit items (root
+ * relative to the most recent chord << 8 | quality id), oldest first, with
+ * the number of chords in bits 36-37. The opening chord of a song has its own
+ * context. A count key is the context key << 12 | the 12-bit next item.
+ */
+static const std::uint64_t START_CONTEXT = 1ull << 38;
+static const std::uint32_t FORMAT_VERSION = 1;
+
+struct RecentChord {
+    int root;
+    int quality;
+};
+
+static unsigned relativeMask(unsigned mask, int root) {
+    return ((mask >> root) | (mask << (12 - root))) & 0xFFFu;
+}
+
+static std::uint64_t contextKey(const RecentChord* recent, int available, int length) {
+    const int lastRoot = recent[available - 1].root;
+    std::uint64_t key = static_cast<std::uint64_t>(length) << 36;
+    for (int j = 0; j < length; ++j) {
+        const RecentChord& c = recent[available - length + j];
+        const std::uint64_t item = static_cast<std::uint64_t>(((c.root - lastRoot + 12) % 12) << 8 | c.quality);
+        key |= item << (12 * j);
+    }
+    return key;
+}
+
+static void buildQualityIds(const std::vector<std::string>& names, std::array<std::int16_t, 4096>& ids) {
+    ids.fill(-1);
+    auto& manager = QualityManager::Instance();
+    for (std::size_t id = 0; id < names.size(); ++id) {
+        if (!manager.hasQuality(names[id])) continue;
+        auto quality = manager.getQuality(names[id]);
+        unsigned mask = 0;
+        for (int interval : quality->getIntervals()) mask |= 1u << (((interval % 12) + 12) % 12);
+        if (ids[mask] < 0) ids[mask] = static_cast<std::int16_t>(id);
+    }
+}
+
+TransitionModel::TransitionModel() {
+    m_qualityIds.fill(-1);
+}
+
+TransitionModel::~TransitionModel() {
+    release();
+}
+
+TransitionModel::TransitionModel(TransitionModel&& other) noexcept {
+    *this = std::move(other);
+}
+
+TransitionModel& TransitionModel::operator=(TransitionModel&& other) noexcept {
+    if (this != &other) {
+        release();
+        // Moving the vector keeps its storage, so the record pointers stay valid
+        m_buffer = std::move(other.m_buffer);
+        m_data = other.m_data;
+        m_dataSize = other.m_dataSize;
+        m_file = std::move(other.m_file);
+        m_header = other.m_header;
+        m_contexts = other.m_contexts;
+        m_entries = other.m_entries;
+        m_names = std::move(other.m_names);
+        m_qualityIds = other.m_qualityIds;
+        other.m_file.reset();
+        other.m_data = nullptr;
+        other.m_dataSize = 0;
+        other.m_header = nullptr;
+        other.m_contexts = nullptr;
+        other.m_entries = nullptr;
+    }
+    return *this;
+}
+
+void TransitionModel::release() {
+    m_file.reset();
+    m_buffer.clear();
+    m_data = nullptr;
+    m_dataSize = 0;
+    m_header = nullptr;
+    m_contexts = nullptr;
+    m_entries = nullptr;
+}
+
+void TransitionModel::attach(const char* data, std::size_t size) {
+    if (size < sizeof(Header)) {
+        throw std::runtime_error("Transition model data is truncated.");
+    }
+    const auto* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, "CYNG", 4) != 0 || header->version != FORMAT_VERSION) {
+        throw std::runtime_error("Not a transition model, or an unsupported version.");
+    }
+    const std::size_t expected = sizeof(Header)
+                               + std::size_t(header->contextCount) * sizeof(ContextRecord)
+                               + std::size_t(header->entryCount) * sizeof(EntryRecord)
+                               + header->namesBytes;
+    if (size < expected || header->context < 1 || header->context > MAX_CONTEXT) {
+        throw std::runtime_error("Transition model data is corrupt.");
+    }
+    const auto* contexts = reinterpret_cast<const ContextRecord*>(data + sizeof(Header));
+    const auto* entries = reinterpret_cast<const EntryRecord*>(contexts + header->contextCount);
+    for (std::uint32_t i = 0; i < header->contextCount; ++i) {
+        if (std::uint64_t(contexts[i].first) + contexts[i].count > header->entryCount) {
+            throw std::runtime_error("Transition model data is corrupt.");
+        }
+    }
+
+    const char* names = reinterpret_cast<const char*>(entries + header->entryCount);
+    const char* namesEnd = names + header->namesBytes;
+    m_names.clear();
+    for (std::uint32_t i = 0; i < header->nameCount; ++i) {
+        if (names >= namesEnd) {
+            throw std::runtime_error("Transition model data is corrupt.");
+        }
+        std::size_t length = static_cast<unsigned char>(*names++);
+        if (names + length > namesEnd) {
+            throw std::runtime_error("Transition model data is corrupt.");
+        }
+        m_names.emplace_back(names, length);
+        names += length;
+    }
+    buildQualityIds(m_names, m_qualityIds);
+
+    m_data = data;
+    m_dataSize = size;
+    m_header = header;
+    m_contexts = contexts;
+    m_entries = entries;
+}
+
+TransitionModel TransitionModel::train(const std::vector<ChordProgression>& corpus, int context, unsigned threads) {
+    if (context < 1 || context > MAX_CONTEXT) {
+        throw std::runtime_error("Transition model context must be between 1 and " + std::to_string(MAX_CONTEXT) + ".");
+    }
+
+    // Vocabulary: one name per distinct tone set, first in DEFAULT_QUALITIES order
+    TransitionModel model;
+    std::vector<bool> seen(4096, false);
+    for (const auto& entry : DEFAULT_QUALITIES) {
+        unsigned mask = 0;
+        for (int interval : entry.second) mask |= 1u << (((interval % 12) + 12) % 12);
+        if (!seen[mask]) {
+            seen[mask] = true;
+            model.m_names.push_back(entry.first);
+        }
+    }
+    buildQualityIds(model.m_names, model.m_qualityIds);
+    const auto& qualityIds = model.m_qualityIds;
+
+    // Fixed shards, so the merged result does not depend on the thread count
+    const std::size_t shardCount = std::max<std::size_t>(1, std::min<std::size_t>(corpus.size(), 64));
+    std::vector<std::unordered_map<std::uint64_t, std::uint32_t>> shards(shardCount);
+    parallelFor(shardCount, threads, [&](std::size_t s) {
+        auto& counts = shards[s];
+        const std::size_t begin = s * corpus.size() / shardCount;
+        const std::size_t end = (s + 1) * corpus.size() / shardCount;
+        RecentChord recent[MAX_CONTEXT];
+        for (std::size_t song = begin; song < end; ++song) {
+            const ChordProgression& progression = corpus[song];
+            int available = 0;
+            bool opening = true;
+            for (std::size_t i = 0; i < progression.size(); ++i) {
+                const Chord& chord = progression[i];
+                const int root = noteToVal(chord.rootView());
+                const int quality = qualityIds[relativeMask(chord.pitchClassMask(), root)];
+                if (quality < 0) {
+                    available = 0;  // unknown tone set: start a fresh context
+                    opening = false;
+                    continue;
+                }
+                if (available == 0) {
+                    if (opening) ++counts[(START_CONTEXT << 12) | static_cast<std::uint64_t>(quality)];
+                } else {
+                    const int rel = (root - recent[available - 1].root + 12) % 12;
+                    const std::uint64_t next = static_cast<std::uint64_t>(rel << 8 | quality);
+                    for (int length = 0; length <= std::min(available, context); ++length) {
+                        ++counts[(contextKey(recent, available, length) << 12) | next];
+                    }
+                }
+                opening = false;
+                if (available == context) {
+                    std::move(recent + 1, recent + available, recent);
+                    --available;
+                }
+                recent[available++] = RecentChord{root, quality};
+            }
+        }
+    });
+
+    // Merge the shard tables, then group by context with the likeliest entries first
+    auto& merged = shards[0];
+    for (std::size_t s = 1; s < shardCount; ++s) {
+        for (const auto& kv : shards[s]) {
+            std::uint32_t& count = merged[kv.first];
+            count = static_cast<std::uint32_t>(std::min<std::uint64_t>(0xFFFFFFFFu, std::uint64_t(count) + kv.second));
+        }
+        shards[s] = {};
+    }
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> all(merged.begin(), merged.end());
+    merged = {};
+    std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) {
+        if ((a.first >> 12) != (b.first >> 12)) return (a.first >> 12) < (b.first >> 12);
+        if (a.second != b.second) return a.second > b.second;
+        return a.first < b.first;
+    });
+
+    std::vector<ContextRecord> contexts;
+    std::vector<EntryRecord> entries;
+    entries.reserve(all.size());
+    for (const auto& kv : all) {
+        const std::uint64_t key = kv.first >> 12;
+        if (contexts.empty() || contexts.back().key != key) {
+            contexts.push_back(ContextRecord{key, 0, static_cast<std::uint32_t>(entries.size()), 0, 0});
+        }
+        ContextRecord& c = contexts.back();
+        c.total = static_cast<std::uint32_t>(std::min<std::uint64_t>(0xFFFFFFFFu, std::uint64_t(c.total) + kv.second));
+        ++c.count;
+        entries.push_back(EntryRecord{kv.second, static_cast<std::uint16_t>(kv.first & 0xFFF), 0});
+    }
+
+    std::string names;
+    for (const auto& name : model.m_names) {
+        names += static_cast<char>(name.size());
+        names += name;
+    }
+    Header header{{'C', 'Y', 'N', 'G'}, FORMAT_VERSION, static_cast<std::uint32_t>(context),
+                  static_cast<std::uint32_t>(model.m_names.size()),
+                  static_cast<std::uint32_t>(contexts.size()),
+                  static_cast<std::uint32_t>(entries.size()),
+                  static_cast<std::uint32_t>(names.size()), 0};
+
+    auto& buffer = model.m_buffer;
+    buffer.resize(sizeof(Header) + contexts.size() * sizeof(ContextRecord)
+                  + entries.size() * sizeof(EntryRecord) + names.size());
+    char* out = buffer.data();
+    std::memcpy(out, &header, sizeof(Header));
+    out += sizeof(Header);
+    std::memcpy(out, contexts.data(), contexts.size() * sizeof(ContextRecord));
+    out += contexts.size() * sizeof(ContextRecord);
+    std::memcpy(out, entries.data(), entries.size() * sizeof(EntryRecord));
+    out += entries.size() * sizeof(EntryRecord);
+    std::memcpy(out, names.data(), names.size());
+    model.attach(buffer.data(), buffer.size());
+    return model;
+}
+
+const TransitionModel::ContextRecord* TransitionModel::findContext(std::uint64_t key) const {
+    if (!m_header) {
+        return nullptr;
+    }
+    const ContextRecord* end = m_contexts + m_header->contextCount;
+    const ContextRecord* it = std::lower_bound(m_contexts, end, key,
+        [](const ContextRecord& c, std::uint64_t k) { return c.key < k; });
+    return (it != end && it->key == key && it->count > 0) ? it : nullptr;
+}
+
+Chord TransitionModel::makeChord(int lastRoot, std::uint16_t next) const {
+    const std::size_t quality = next & 0xFF;
+    if (quality >= m_names.size()) {
+        throw std::runtime_error("Transition model data is corrupt.");
+    }
+    return Chord::fromParts(valToNote((lastRoot + (next >> 8)) % 12), m_names[quality]);
+}
+
+// Longest trained context for the tail of 'history'; lastRoot receives the root the prediction is relative to
+const TransitionModel::ContextRecord* TransitionModel::longestContext(const ChordProgression& history, int& lastRoot) const {
+    RecentChord recent[MAX_CONTEXT];
+    const int context = static_cast<int>(m_header ? m_header->context : 0);
+    int available = 0;
+    for (std::size_t i = history.size(); i-- > 0 && available < context;) {
+        const int root = noteToVal(history[i].rootView());
+        const int quality = m_qualityIds[relativeMask(history[i].pitchClassMask(), root)];
+        if (quality < 0) break;
+        recent[context - 1 - available++] = RecentChord{root, quality};
+    }
+    const RecentChord* tail = recent + (context - available);
+
+    lastRoot = 0;
+    if (available > 0) {
+        lastRoot = tail[available - 1].root;
+        for (int length = available; length >= 0; --length) {
+            if (const ContextRecord* c = findContext(contextKey(tail, available, length))) {
+                return c;
+            }
+        }
+    }
+    return findContext(START_CONTEXT);
+}
+
+std::vector<ChordPrediction> TransitionModel::predict(const ChordProgression& history, std::size_t k) const {
+    std::vector<ChordPrediction> result;
+    int lastRoot = 0;
+    const ContextRecord* c = longestContext(history, lastRoot);
+    if (!c) {
+        return result;
+    }
+    const std::size_t count = std::min<std::size_t>(k, c->count);
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const EntryRecord& e = m_entries[c->first + i];
+        result.push_back(ChordPrediction{makeChord(lastRoot, e.next), double(e.count) / c->total});
+    }
+    return result;
+}
+
+ChordProgression TransitionModel::generate(std::size_t length, std::uint64_t seed,
+                                           const std::string& tonic, double temperature) const {
+    if (!findContext(START_CONTEXT)) {
+        throw std::runtime_error("Cannot generate from an empty transition model.");
+    }
+    if (temperature <= 0.0) {
+        throw std::runtime_error("Temperature must be positive.");
+    }
+
+    // splitmix64, so a seed gives the same progression on every platform
+    auto random = [&seed]() {
+        std::uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return double((z ^ (z >> 31)) >> 11) * (1.0 / 9007199254740992.0);
+    };
+
+    // Generated in C, then moved to the tonic
+    ChordProgression progression;
+    for (std::size_t i = 0; i < length; ++i) {
+        int lastRoot = 0;
+        const ContextRecord* c = longestContext(progression, lastRoot);
+        double total = 0.0;
+        for (std::uint32_t e = 0; e < c->count; ++e) {
+            total += std::pow(double(m_entries[c->first + e].count), 1.0 / temperature);
+        }
+        double pick = random() * total;
+        std::uint32_t chosen = c->count - 1;
+        for (std::uint32_t e = 0; e < c->count; ++e) {
+            pick -= std::pow(double(m_entries[c->first + e].count), 1.0 / temperature);
+            if (pick < 0.0) {
+                chosen = e;
+                break;
+            }
+        }
+        progression.append(makeChord(lastRoot, m_entries[c->first + chosen].next));
+    }
+    progression.transpose(noteToVal(tonic));
+    return progression;
+}
+
+void TransitionModel::save(const std::string& path) const {
+    if (!m_data) {
+        throw std::runtime_error("Cannot save an empty transition model.");
+    }
+    std::ofstream out(path, std::ios::binary);
+    if (!out.write(m_data, static_cast<std::streamsize>(m_dataSize))) {
+        throw std::runtime_error("Cannot write transition model: " + path);
+    }
+}
+
+TransitionModel TransitionModel::load(const std::string& path) {
+    TransitionModel model;
+    model.m_file.emplace(path);
+    model.attach(model.m_file->data(), model.m_file->size());
+    return model;
+}
+
+int TransitionModel::context() const {
+    return m_header ? static_cast<int>(m_header->context) : 0;
+}
+
+std::size_t TransitionModel::contextCount() const {
+    return m_header ? m_header->contextCount : 0;
+}
+
+std::size_t TransitionModel::transitionCount() const {
+    return m_header ? m_header->entryCount : 0;
+}
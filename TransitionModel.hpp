@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "ChordProgression.hpp"
+#include "MappedFile.hpp"
+
+/**
+ * Transposition-relative n-gram model of chord transitions.
+ *
+ * A transition is stored as (root interval from the previous chord, quality),
+ * conditioned on the qualities and relative roots of up to 'context' earlier
+ * chords, so "Dm7 G7" and "Em7 A7" count as the same pattern. Qualities are
+ * those of DEFAULT_QUALITIES (chords with other tone sets break the sequence).
+ * Prediction backs off to the longest context seen in training.
+ *
+ * The model lives in one flat buffer that is also its file format: save()
+ * writes it as is, and load() maps the file read-only, so loading is
+ * instant and the pages are shared between processes.
+ */
+
+struct ChordPrediction {
+    Chord chord;
+    double probability;  // within the context the prediction came from
+};
+
+class TransitionModel {
+public:
+    static const int MAX_CONTEXT = 3;
+
+    TransitionModel();
+    ~TransitionModel();
+    TransitionModel(TransitionModel&& other) noexcept;
+    TransitionModel& operator=(TransitionModel&& other) noexcept;
+    TransitionModel(const TransitionModel&) = delete;
+    TransitionModel& operator=(const TransitionModel&) = delete;
+
+    /**
+     * Count transitions over a corpus. Songs are split into fixed shards, each
+     * counted into its own table on up to 'threads' workers (0 = hardware
+     * concurrency), and the tables are merged at the end; the result does not
+     * depend on the thread count.
+     */
+    static TransitionModel train(const std::vector<ChordProgression>& corpus,
+                                 int context = 2, unsigned threads = 0);
+
+    // Most likely next chords after 'history' (the opening chord if it is empty)
+    std::vector<ChordPrediction> predict(const ChordProgression& history, std::size_t k = 5) const;
+
+    /**
+     * Sample a progression of 'length' chords in 'tonic'. Counts are raised to
+     * 1 / temperature before sampling; the same seed gives the same result.
+     */
+    ChordProgression generate(std::size_t length, std::uint64_t seed,
+                              const std::string& tonic = "C", double temperature = 1.0) const;
+
+    void save(const std::string& path) const;
+    static TransitionModel load(const std::string& path);
+
+    int context() const;
+    std::size_t contextCount() const;
+    std::size_t transitionCount() const;
+
+private:
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t context;
+        std::uint32_t nameCount;
+        std::uint32_t contextCount;
+        std::uint32_t entryCount;
+        std::uint32_t namesBytes;
+        std::uint32_t reserved;
+    };
+    struct ContextRecord {
+        std::uint64_t key;
+        std::uint32_t total;
+        std::uint32_t first;   // index of its first EntryRecord
+        std::uint32_t count;
+        std::uint32_t reserved;
+    };
+    struct EntryRecord {
+        std::uint32_t count;
+        std::uint16_t next;    // root interval << 8 | quality id; sorted by count within a context
+        std::uint16_t reserved;
+    };
+
+    // Either an owned buffer (trained) or a read-only mapping (loaded)
+    std::vector<char> m_buffer;
+    std::optional<MappedFile> m_file;
+    const char* m_data = nullptr;
+    std::size_t m_dataSize = 0;
+
+    const Header* m_header = nullptr;
+    const ContextRecord* m_contexts = nullptr;
+    const EntryRecord* m_entries = nullptr;
+    std::vector<std::string> m_names;             // quality name per id
+    std::array<std::int16_t, 4096> m_qualityIds;  // relative pitch-class mask -> id, -1 if unknown
+
+    void attach(const char* data, std::size_t size);
+    void release();
+    const ContextRecord* findContext(std::uint64_t key) const;
+    const ContextRecord* longestContext(const ChordProgression& history, int& lastRoot) const;
+    Chord makeChord(int lastRoot, std::uint16_t next) const;
+};
@@ -5,10 +5,11 @@
 /**
  * Convert a note (e.g. "C", "F#", "Bb") to its semitone integer value (0..11).
  */
-int noteToVal(const std::string& note) {
-    auto it = NOTE_VAL_DICT.find(note);
+int noteToVal(std::string_view note) {
+    // note names are short enough for the small-string buffer, so this key does not allocate
+    auto it = NOTE_VAL_DICT.find(std::string(note));
     if (it == NOTE_VAL_DICT.end()) {
-        throw std::runtime_error("Unknown note: " + note);
+        throw std::runtime_error("Unknown note: " + std::string(note));
     }
     return it->second;
 }
@@ -17,9 +18,9 @@ int noteToVal(const std::string& note) {
  * Convert an integer value to a note name, according to the scale chosen by scaleRoot.
  * e.g. valToNote(0,"C") -> "C", valToNote(1,"A") -> "A#" or "Bb", depending on dictionary.
  */
-std::string valToNote(int val, const std::string& scaleRoot) {
-    val = val % 12;
-    auto scaleIt = SCALE_VAL_DICT.find(scaleRoot);
+std::string valToNote(int val, std::string_view scaleRoot) {
+    val = ((val % 12) + 12) % 12;
+    auto scaleIt = SCALE_VAL_DICT.find(std::string(scaleRoot));
     if (scaleIt == SCALE_VAL_DICT.end()) {
         // fallback to "C" scale if scaleRoot not found
         return FLATTED_SCALE.at(val);
@@ -32,7 +33,7 @@ std::string valToNote(int val, const std::string& scaleRoot) {
 /**
  * Transpose a given note by some number of semitones, returning the new note name.
  */
-std::string transposeNote(const std::string& note, int semitones, const std::string& scale) {
+std::string transposeNote(std::string_view note, int semitones, std::string_view scale) {
     int val = noteToVal(note);
     val += semitones;
     return valToNote(val, scale);
@@ -54,9 +55,9 @@ std::string displayAppended(const std::vector<std::string>& appended) {
     return result;
 }
 
-std::string displayOn(const std::string& onNote) {
+std::string displayOn(std::string_view onNote) {
     if (!onNote.empty()) {
-        return "/" + onNote;
+        return "/" + std::string(onNote);
     }
     return std::string();
 }
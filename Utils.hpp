@@ -1,16 +1,29 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
  * Utilities for note conversion, transposition, and display.
  */
 
-int noteToVal(const std::string& note);
-std::string valToNote(int val, const std::string& scaleRoot = "C");
-std::string transposeNote(const std::string& note, int semitones, const std::string& scale = "C");
+// Take string_view so std::string and std::pmr::string members both work without copies
+int noteToVal(std::string_view note);
+std::string valToNote(int val, std::string_view scaleRoot = "C");
+std::string transposeNote(std::string_view note, int semitones, std::string_view scale = "C");
 
 // For chord name rendering
 std::string displayAppended(const std::vector<std::string>& appended);
-std::string displayOn(const std::string& onNote);
+std::string displayOn(std::string_view onNote);
+
+// Number of pitch classes in a 12-bit mask (bit 0 = C)
+inline int popcount12(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(mask & 0xFFFu);
+#else
+    int n = 0;
+    for (mask &= 0xFFFu; mask; mask &= mask - 1) ++n;
+    return n;
+#endif
+}
@@ -0,0 +1,121 @@
+#include "WavReader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static std::uint32_t readLE(const unsigned char* p, int bytes) {
+    std::uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+WavReader::WavReader(const std::string& path)
+    : m_in(path, std::ios::binary)
+{
+    if (!m_in) {
+        throw std::runtime_error("Cannot open WAV file: " + path);
+    }
+    unsigned char header[12];
+    if (!m_in.read(reinterpret_cast<char*>(header), 12)
+        || std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0) {
+        throw std::runtime_error("Not a RIFF/WAVE file: " + path);
+    }
+
+    bool haveFormat = false;
+    unsigned char chunk[8];
+    while (m_in.read(reinterpret_cast<char*>(chunk), 8)) {
+        std::uint32_t size = readLE(chunk + 4, 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            std::vector<unsigned char> fmt(size);
+            if (size < 16 || !m_in.read(reinterpret_cast<char*>(fmt.data()), size)) {
+                throw std::runtime_error("Malformed fmt chunk in WAV file: " + path);
+            }
+            std::uint32_t format = readLE(fmt.data(), 2);
+            m_channels = static_cast<int>(readLE(fmt.data() + 2, 2));
+            m_sampleRate = static_cast<int>(readLE(fmt.data() + 4, 4));
+            m_bitsPerSample = static_cast<int>(readLE(fmt.data() + 14, 2));
+            if (format == 0xFFFE && size >= 26) {
+                format = readLE(fmt.data() + 24, 2);  // sub-format GUID starts with the tag
+            }
+            if (format != 1 && format != 3) {
+                throw std::runtime_error("Unsupported WAV sample format in: " + path);
+            }
+            m_float = (format == 3);
+            haveFormat = true;
+            if (size & 1) m_in.ignore(1);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                throw std::runtime_error("WAV data chunk before fmt chunk in: " + path);
+            }
+            int bytes = m_bitsPerSample / 8;
+            bool supported = m_float ? (bytes == 4 || bytes == 8) : (bytes >= 1 && bytes <= 4);
+            if (!supported || m_channels <= 0 || m_sampleRate <= 0 || m_bitsPerSample % 8 != 0) {
+                throw std::runtime_error("Unsupported WAV layout in: " + path);
+            }
+            m_frameCount = size / (static_cast<std::uint64_t>(bytes) * m_channels);
+            m_framesLeft = m_frameCount;
+            return;
+        } else {
+            m_in.ignore(size + (size & 1));
+        }
+    }
+    throw std::runtime_error("No data chunk in WAV file: " + path);
+}
+
+int WavReader::sampleRate() const {
+    return m_sampleRate;
+}
+
+int WavReader::channels() const {
+    return m_channels;
+}
+
+int WavReader::bitsPerSample() const {
+    return m_bitsPerSample;
+}
+
+std::uint64_t WavReader::frameCount() const {
+    return m_frameCount;
+}
+
+std::size_t WavReader::readMono(float* out, std::size_t maxFrames) {
+    std::size_t frames = static_cast<std::size_t>(std::min<std::uint64_t>(maxFrames, m_framesLeft));
+    if (frames == 0) {
+        return 0;
+    }
+    const int bytes = m_bitsPerSample / 8;
+    const std::size_t frameBytes = static_cast<std::size_t>(bytes) * m_channels;
+    m_raw.resize(frames * frameBytes);
+    m_in.read(m_raw.data(), static_cast<std::streamsize>(m_raw.size()));
+    frames = static_cast<std::size_t>(m_in.gcount()) / frameBytes;
+    m_framesLeft = frames ? m_framesLeft - frames : 0;
+
+    const auto* p = reinterpret_cast<const unsigned char*>(m_raw.data());
+    const float gain = 1.0f / m_channels;
+    for (std::size_t f = 0; f < frames; ++f) {
+        float sum = 0.0f;
+        for (int c = 0; c < m_channels; ++c, p += bytes) {
+            if (m_float && bytes == 4) {
+                float v;
+                std::uint32_t bits = readLE(p, 4);
+                std::memcpy(&v, &bits, 4);
+                sum += v;
+            } else if (m_float) {
+                std::uint64_t bits = readLE(p, 4) | (static_cast<std::uint64_t>(readLE(p + 4, 4)) << 32);
+                double v;
+                std::memcpy(&v, &bits, 8);
+                sum += static_cast<float>(v);
+            } else if (bytes == 1) {
+                sum += (static_cast<int>(p[0]) - 128) / 128.0f;  // 8-bit PCM is unsigned
+            } else {
+                // Sign-extend from the top byte
+                std::uint32_t raw = readLE(p, bytes) << (32 - 8 * bytes);
+                sum += static_cast<float>(static_cast<std::int32_t>(raw)) / 2147483648.0f;
+            }
+        }
+        out[f] = sum * gain;
+    }
+    return frames;
+}
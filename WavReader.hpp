@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Streaming reader for RIFF/WAVE files: integer PCM (8/16/24/32-bit) and
+ * IEEE float (32/64-bit), including WAVE_FORMAT_EXTENSIBLE. Samples are read
+ * in blocks and mixed down to mono floats in [-1, 1].
+ */
+class WavReader {
+public:
+    explicit WavReader(const std::string& path);
+
+    int sampleRate() const;
+    int channels() const;
+    int bitsPerSample() const;
+    std::uint64_t frameCount() const;
+
+    // Read up to 'maxFrames' mono samples into 'out'; returns 0 at end of data
+    std::size_t readMono(float* out, std::size_t maxFrames);
+
+private:
+    std::ifstream m_in;
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    int m_bitsPerSample = 0;
+    bool m_float = false;
+    std::uint64_t m_frameCount = 0;
+    std::uint64_t m_framesLeft = 0;
+    std::vector<char> m_raw;
+};
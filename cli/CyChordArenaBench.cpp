@@ -0,0 +1,172 @@
+/**
+ * cychord-arena-bench: corpus ingest on the global heap versus a monotonic arena.
+ *
+ *     cychord-arena-bench [options]
+ *
+ *     -s, --songs N       songs in the corpus (default 20000)
+ *     -l, --length N      chords per song (default 64)
+ *     -b, --batch N       songs per batch (default 2000)
+ *     -m, --mode MODE     heap, arena or both (default both)
+ *
+ * A batch of songs is parsed from chord symbols into ChordProgressions,
+ * transposed and summarized, then thrown away: chord by chord on the heap,
+ * or in one release of a std::pmr::monotonic_buffer_resource. Each mode runs
+ * in its own process so the reported peak RSS is its own (POSIX).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../ChordProgression.hpp"
+
+static std::vector<std::string> symbolPool() {
+    static const char* roots[] = {"C", "Db", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"};
+    static const char* qualities[] = {"", "m", "7", "maj7", "m7", "m7-5", "dim7", "sus4", "7b9", "add9"};
+    std::vector<std::string> pool;
+    for (const char* root : roots) {
+        for (const char* quality : qualities) {
+            pool.push_back(std::string(root) + quality);
+        }
+        pool.push_back(std::string(root) + "/E");  // slash chords carry an "on" string
+    }
+    return pool;
+}
+
+// Songs as indices into the pool, from a fixed LCG so both modes see the same corpus
+static std::vector<std::vector<std::uint16_t>> makeCorpus(std::size_t songs, std::size_t length,
+                                                          std::size_t poolSize) {
+    std::vector<std::vector<std::uint16_t>> corpus(songs, std::vector<std::uint16_t>(length));
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (auto& song : corpus) {
+        for (auto& chord : song) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            chord = static_cast<std::uint16_t>((state >> 33) % poolSize);
+        }
+    }
+    return corpus;
+}
+
+struct IngestResult {
+    double seconds;
+    std::uint64_t checksum;
+    long peakKb;
+};
+
+static IngestResult ingest(bool arena, const std::vector<std::vector<std::uint16_t>>& corpus,
+                           const std::vector<std::string>& pool, std::size_t batch) {
+    using Clock = std::chrono::steady_clock;
+    std::uint64_t checksum = 0;
+    const Clock::time_point start = Clock::now();
+    for (std::size_t first = 0; first < corpus.size(); first += batch) {
+        const std::size_t last = std::min(corpus.size(), first + batch);
+        std::pmr::monotonic_buffer_resource buffer(std::size_t(1) << 20);
+        const ChordProgression::allocator_type alloc =
+            arena ? ChordProgression::allocator_type(&buffer) : ChordProgression::allocator_type();
+        std::vector<ChordProgression> songs;
+        songs.reserve(last - first);
+        for (std::size_t s = first; s < last; ++s) {
+            songs.emplace_back(alloc);
+            ChordProgression& song = songs.back();
+            for (std::uint16_t symbol : corpus[s]) {
+                song.emplace_back(pool[symbol]);
+            }
+        }
+        for (ChordProgression& song : songs) {
+            song.transpose(5);
+            const ChordProgression& transposed = song;
+            for (const Chord& chord : transposed.chords()) {
+                checksum += chord.pitchClassMask() + chord.rootView().size() + chord.onView().size();
+            }
+        }
+        // songs, then the arena, are released here
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return IngestResult{seconds, checksum, usage.ru_maxrss};
+}
+
+static void usage() {
+    std::cerr << "usage: cychord-arena-bench [-s N] [-l N] [-b N] [-m heap|arena|both]\n";
+}
+
+int main(int argc, char** argv) {
+    std::size_t songs = 20000;
+    std::size_t length = 64;
+    std::size_t batch = 2000;
+    std::string mode = "both";
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "-s" || arg == "--songs") {
+                songs = std::stoul(value());
+            } else if (arg == "-l" || arg == "--length") {
+                length = std::stoul(value());
+            } else if (arg == "-b" || arg == "--batch") {
+                batch = std::max<std::size_t>(1, std::stoul(value()));
+            } else if (arg == "-m" || arg == "--mode") {
+                mode = value();
+                if (mode != "heap" && mode != "arena" && mode != "both") {
+                    throw std::runtime_error("unknown mode " + mode);
+                }
+            } else if (arg == "-h" || arg == "--help") {
+                usage();
+                return 0;
+            } else {
+                throw std::runtime_error("unknown argument " + arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "cychord-arena-bench: " << e.what() << "\n";
+        usage();
+        return 2;
+    }
+
+    const std::vector<std::string> pool = symbolPool();
+    std::printf("%zu songs x %zu chords, batches of %zu\n", songs, length, batch);
+    for (const char* name : {"heap", "arena"}) {
+        if (mode != "both" && mode != name) continue;
+        const bool arena = std::string(name) == "arena";
+        std::fflush(stdout);
+        const pid_t child = fork();
+        if (child < 0) {
+            std::perror("cychord-arena-bench: fork");
+            return 1;
+        }
+        if (child == 0) {
+            // The corpus is built in the child too, so both modes start from the same footprint
+            const auto corpus = makeCorpus(songs, length, pool.size());
+            try {
+                const IngestResult r = ingest(arena, corpus, pool, batch);
+                const double chords = static_cast<double>(songs) * length;
+                std::printf("%-5s %8.3f s  %6.2f M chords/s  peak RSS %7ld KiB  checksum %llu\n", name,
+                            r.seconds, chords / r.seconds / 1e6, r.peakKb,
+                            static_cast<unsigned long long>(r.checksum));
+            } catch (const std::exception& e) {
+                std::cerr << "cychord-arena-bench: " << e.what() << "\n";
+                _exit(1);
+            }
+            std::fflush(stdout);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
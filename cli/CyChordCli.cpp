@@ -0,0 +1,110 @@
+/**
+ * cychord: stream chord symbols or MIDI note lists through the library.
+ *
+ *     cychord [options] [file ...]      (no files, or "-", reads stdin)
+ *
+ *     -t, --transpose N   transpose by N semitones
+ *     -s, --scale KEY     spelling for roots and tones (default: the key's tonic, else C)
+ *     -n, --normalize     one quality name per tone set ("CM7" -> "Cmaj7")
+ *     -a, --analyze       append chord tones, e.g. "Am7[A C E G]"
+ *     -k, --key KEY       append Roman numerals in KEY, e.g. "Cmaj", "Amin"
+ *     -j, --jobs N        worker threads (default: all cores)
+ *     -b, --batch N       lines per batch (default 512)
+ *     -q, --quiet         no summary on stderr
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../ChordPipeline.hpp"
+#include "../Diatonic.hpp"
+
+static void usage() {
+    std::cerr << "usage: cychord [-t N] [-s KEY] [-n] [-a] [-k KEY] [-j N] [-b N] [-q] [file ...]\n";
+}
+
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+
+    PipelineOptions options;
+    std::vector<std::string> files;
+    bool quiet = false;
+    bool scaleGiven = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "-t" || arg == "--transpose") {
+                options.transpose = std::stoi(value());
+            } else if (arg == "-s" || arg == "--scale") {
+                options.scale = value();
+                scaleGiven = true;
+            } else if (arg == "-n" || arg == "--normalize") {
+                options.normalize = true;
+            } else if (arg == "-a" || arg == "--analyze") {
+                options.analyze = true;
+            } else if (arg == "-k" || arg == "--key") {
+                options.key = value();
+            } else if (arg == "-j" || arg == "--jobs") {
+                options.workers = static_cast<unsigned>(std::stoul(value()));
+            } else if (arg == "-b" || arg == "--batch") {
+                options.batchLines = std::stoul(value());
+            } else if (arg == "-q" || arg == "--quiet") {
+                quiet = true;
+            } else if (arg == "-h" || arg == "--help") {
+                usage();
+                return 0;
+            } else if (arg.size() > 1 && arg[0] == '-') {
+                throw std::runtime_error("unknown option " + arg);
+            } else {
+                files.push_back(arg);
+            }
+        }
+        if (!options.key.empty() && !scaleGiven) {
+            int mode = 0;
+            parseScale(options.key, options.scale, mode);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "cychord: " << e.what() << "\n";
+        usage();
+        return 2;
+    }
+    if (files.empty()) {
+        files.push_back("-");
+    }
+
+    PipelineStats total;
+    try {
+        for (const auto& file : files) {
+            PipelineStats stats;
+            if (file == "-") {
+                stats = runChordPipeline(std::cin, std::cout, options);
+            } else {
+                std::ifstream in(file);
+                if (!in) {
+                    throw std::runtime_error("cannot open " + file);
+                }
+                stats = runChordPipeline(in, std::cout, options);
+            }
+            total.lines += stats.lines;
+            total.chords += stats.chords;
+            total.errors += stats.errors;
+        }
+        std::cout.flush();
+    } catch (const std::exception& e) {
+        std::cerr << "cychord: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (!quiet) {
+        std::cerr << total.lines << " lines, " << total.chords << " chords, "
+                  << total.errors << " not recognized\n";
+    }
+    return total.errors ? 3 : 0;
+}
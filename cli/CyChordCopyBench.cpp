@@ -0,0 +1,163 @@
+/**
+ * cychord-copy-bench: heap allocations of the copying APIs versus the move /
+ * emplace / view APIs of Chord and ChordProgression.
+ *
+ *     cychord-copy-bench [-n CHORDS]   (default 100000)
+ *
+ * Global operator new is replaced by a counting one, so every allocation of
+ * the process is seen, including those of the default pmr resource (which
+ * goes through the aligned overloads). Each pipeline stage is run once the
+ * old way (build a Chord, then copy it in; copy vectors and progressions;
+ * read through by-value accessors) and once the new way (emplace from the
+ * symbol, move, read through views).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../ChordProgression.hpp"
+
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned overloads
+void* operator new(std::size_t size, std::align_val_t align) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+struct StageCount {
+    std::size_t allocations;
+    double seconds;
+};
+
+static StageCount measure(const std::function<void()>& stage) {
+    const std::size_t a0 = allocations.load();
+    const auto t0 = std::chrono::steady_clock::now();
+    stage();
+    const auto t1 = std::chrono::steady_clock::now();
+    return StageCount{allocations.load() - a0, std::chrono::duration<double>(t1 - t0).count()};
+}
+
+static void report(const char* stage, std::size_t chords, const StageCount& copy, const StageCount& move) {
+    std::printf("%-12s copy %9zu allocs %6.2f/chord %7.1f ms | move %9zu allocs %6.2f/chord %7.1f ms\n", stage,
+                copy.allocations, static_cast<double>(copy.allocations) / chords, copy.seconds * 1e3,
+                move.allocations, static_cast<double>(move.allocations) / chords, move.seconds * 1e3);
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = 100000;
+    if (argc == 3 && std::string(argv[1]) == "-n") {
+        count = std::stoul(argv[2]);
+    } else if (argc != 1) {
+        std::cerr << "usage: cychord-copy-bench [-n CHORDS]\n";
+        return 2;
+    }
+
+    static const char* symbols[] = {"C", "Am7", "F#m7-5/A", "Bbmaj7", "G7/B", "Ebdim7", "Dsus4", "Abaug",
+                                    "E7b9", "Cadd9", "Fm6", "Db13"};
+    std::vector<std::string> input;
+    input.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        input.push_back(symbols[i % (sizeof(symbols) / sizeof(symbols[0]))]);
+    }
+    std::size_t sink = 0;
+    std::printf("%zu chords\n", count);
+
+    // 1) Ingest: parse each symbol into a progression
+    ChordProgression copied;
+    ChordProgression moved;
+    const StageCount ingestCopy = measure([&] {
+        for (const std::string& symbol : input) {
+            Chord chord(symbol);
+            copied.append(chord);
+        }
+    });
+    const StageCount ingestMove = measure([&] {
+        for (const std::string& symbol : input) {
+            moved.emplace_back(symbol);
+        }
+    });
+    report("ingest", count, ingestCopy, ingestMove);
+
+    // 2) Hand a std::vector<Chord> over to a progression
+    const ChordProgression& parsed = moved;
+    std::vector<Chord> vectorA(parsed.chords().begin(), parsed.chords().end());
+    std::vector<Chord> vectorB(vectorA);
+    ChordProgression fromCopy;
+    ChordProgression fromMove;
+    const StageCount vectorCopy = measure([&] { fromCopy = ChordProgression(vectorA); });
+    const StageCount vectorMove = measure([&] { fromMove = ChordProgression(std::move(vectorB)); });
+    report("from vector", count, vectorCopy, vectorMove);
+
+    // 3) Concatenate two halves
+    ChordProgression joinedCopy;
+    ChordProgression joinedMove;
+    const StageCount concatCopy = measure([&] {
+        joinedCopy += fromCopy;
+        joinedCopy += copied;
+    });
+    const StageCount concatMove = measure([&] {
+        joinedMove.extend(std::move(fromMove));
+        joinedMove.extend(std::move(moved));
+    });
+    report("concatenate", 2 * count, concatCopy, concatMove);
+
+    // 4) Read every chord's name, root, bass and added notes
+    const ChordProgression& reader = joinedCopy;
+    const StageCount readCopy = measure([&] {
+        for (const Chord& chord : reader.chords()) {
+            sink += chord.chordName().size() + chord.root().size() + chord.on().size() + chord.appended().size();
+        }
+    });
+    const StageCount readMove = measure([&] {
+        for (const Chord& chord : reader.chords()) {
+            sink += chord.chordNameView().size() + chord.rootView().size() + chord.onView().size() +
+                    chord.appendedView().size();
+        }
+    });
+    report("read", reader.size(), readCopy, readMove);
+
+    const std::size_t copyTotal = ingestCopy.allocations + vectorCopy.allocations + concatCopy.allocations +
+                                  readCopy.allocations;
+    const std::size_t moveTotal = ingestMove.allocations + vectorMove.allocations + concatMove.allocations +
+                                  readMove.allocations;
+    std::printf("total        copy %9zu allocs | move %9zu allocs (%.1f%%)   [%zu]\n", copyTotal, moveTotal,
+                copyTotal ? 100.0 * moveTotal / copyTotal : 0.0, sink % 10);
+    return joinedCopy == joinedMove ? 0 : 1;
+}
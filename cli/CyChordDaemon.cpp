@@ -0,0 +1,80 @@
+/**
+ * cychordd: serve parse, recognize and transpose requests on a Unix socket.
+ *
+ *     cychordd [options] SOCKET
+ *
+ *     -j, --jobs N        worker threads (default: all cores)
+ *     -b, --batch N       most requests per batch (default 256)
+ *     -q, --quiet         no summary on stderr
+ *
+ * SIGINT and SIGTERM stop the server and remove the socket file.
+ */
+
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "../ChordServer.hpp"
+
+static ChordServer* g_server = nullptr;
+
+static void onSignal(int) {
+    if (g_server) g_server->stop();
+}
+
+static void usage() {
+    std::cerr << "usage: cychordd [-j N] [-b N] [-q] SOCKET\n";
+}
+
+int main(int argc, char** argv) {
+    ServerOptions options;
+    std::string path;
+    bool quiet = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "-j" || arg == "--jobs") {
+                options.workers = static_cast<unsigned>(std::stoul(value()));
+            } else if (arg == "-b" || arg == "--batch") {
+                options.maxBatch = std::stoul(value());
+            } else if (arg == "-q" || arg == "--quiet") {
+                quiet = true;
+            } else if (arg == "-h" || arg == "--help") {
+                usage();
+                return 0;
+            } else if (arg.size() > 1 && arg[0] == '-') {
+                throw std::runtime_error("unknown option " + arg);
+            } else if (path.empty()) {
+                path = arg;
+            } else {
+                throw std::runtime_error("more than one socket path");
+            }
+        }
+        if (path.empty()) throw std::runtime_error("no socket path");
+    } catch (const std::exception& e) {
+        std::cerr << "cychordd: " << e.what() << "\n";
+        usage();
+        return 2;
+    }
+
+    try {
+        ChordServer server(path, options);
+        g_server = &server;
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        const ServerStats stats = server.run();
+        g_server = nullptr;
+        if (!quiet) {
+            std::cerr << stats.connections << " connections, " << stats.requests << " requests, "
+                      << stats.batches << " batches\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "cychordd: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * cychord-load: load generator for cychordd, or for the same engine in-process.
+ *
+ *     cychord-load [options] [SOCKET]   (no SOCKET: in-process)
+ *
+ *     -c, --clients N     concurrent clients (default 8)
+ *     -n, --requests N    requests per client (default 20000)
+ *     -p, --pipeline N    requests per round trip (default 1)
+ *
+ * Each client cycles through a fixed mix of parse, transpose and recognize
+ * requests. Latency is measured per round trip; the report gives p50 and
+ * p99 in microseconds and total requests per second.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../ChordClient.hpp"
+#include "../ChordService.hpp"
+
+static std::vector<ChordRequest> requestMix() {
+    static const char* symbols[] = {"C", "Am7", "F#m7-5", "Bbmaj7", "G7/B", "Ebdim7", "Dsus4", "Abaug"};
+    static const int notes[][4] = {{60, 64, 67, 0}, {57, 60, 64, 67}, {55, 59, 62, 65}, {52, 55, 59, 62}};
+    std::vector<ChordRequest> mix;
+    for (const char* symbol : symbols) {
+        ChordRequest parse;
+        parse.op = ChordOp::Parse;
+        parse.payload = symbol;
+        mix.push_back(parse);
+        ChordRequest transpose = parse;
+        transpose.op = ChordOp::Transpose;
+        transpose.arg = 5;
+        mix.push_back(transpose);
+    }
+    for (const auto& chord : notes) {
+        ChordRequest recognize;
+        recognize.op = ChordOp::Recognize;
+        for (int note : chord) {
+            if (note) recognize.payload += static_cast<char>(note);
+        }
+        mix.push_back(recognize);
+    }
+    return mix;
+}
+
+static void usage() {
+    std::cerr << "usage: cychord-load [-c N] [-n N] [-p N] [SOCKET]\n";
+}
+
+int main(int argc, char** argv) {
+    std::size_t clients = 8;
+    std::size_t perClient = 20000;
+    std::size_t pipeline = 1;
+    std::string path;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::size_t {
+                if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+                return std::stoul(argv[++i]);
+            };
+            if (arg == "-c" || arg == "--clients") {
+                clients = std::max<std::size_t>(1, value());
+            } else if (arg == "-n" || arg == "--requests") {
+                perClient = value();
+            } else if (arg == "-p" || arg == "--pipeline") {
+                pipeline = std::max<std::size_t>(1, value());
+            } else if (arg == "-h" || arg == "--help") {
+                usage();
+                return 0;
+            } else if (arg.size() > 1 && arg[0] == '-') {
+                throw std::runtime_error("unknown option " + arg);
+            } else {
+                path = arg;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "cychord-load: " << e.what() << "\n";
+        usage();
+        return 2;
+    }
+
+    const std::vector<ChordRequest> mix = requestMix();
+    std::unique_ptr<ChordService> service;
+    if (path.empty()) service.reset(new ChordService());
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<std::size_t> failures(clients, 0);
+    std::vector<std::string> errors(clients);
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    std::vector<std::thread> threads;
+    for (std::size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            try {
+                std::unique_ptr<ChordClient> client;
+                if (!service) client.reset(new ChordClient(path));
+                std::vector<ChordRequest> round;
+                std::vector<ChordResponse> responses(pipeline);
+                latencies[c].reserve(perClient / pipeline + 1);
+                for (std::size_t sent = 0; sent < perClient; sent += round.size()) {
+                    round.clear();
+                    for (std::size_t i = sent; i < perClient && round.size() < pipeline; ++i) {
+                        round.push_back(mix[(i + c) % mix.size()]);
+                    }
+                    const Clock::time_point t0 = Clock::now();
+                    if (client) {
+                        responses = client->call(round);
+                    } else {
+                        service->handleBatch(round.data(), round.size(), responses.data());
+                    }
+                    const Clock::time_point t1 = Clock::now();
+                    latencies[c].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+                    for (std::size_t i = 0; i < round.size(); ++i) {
+                        if (responses[i].status != ChordStatus::Ok) ++failures[c];
+                    }
+                }
+            } catch (const std::exception& e) {
+                errors[c] = e.what();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    std::size_t failed = 0;
+    for (std::size_t c = 0; c < clients; ++c) {
+        if (!errors[c].empty()) {
+            std::cerr << "cychord-load: client " << c << ": " << errors[c] << "\n";
+            return 1;
+        }
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        failed += failures[c];
+    }
+    if (all.empty()) {
+        std::cerr << "cychord-load: no requests sent\n";
+        return 1;
+    }
+    auto percentile = [&](double p) {
+        const std::size_t at = std::min(all.size() - 1, static_cast<std::size_t>(p * all.size()));
+        std::nth_element(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(at), all.end());
+        return all[at];
+    };
+    const std::size_t total = clients * perClient;
+    std::printf("mode %s, %zu clients, %zu requests, pipeline %zu\n",
+                service ? "in-process" : "daemon", clients, total, pipeline);
+    std::printf("p50 %.1f us, p99 %.1f us per round trip\n", percentile(0.50), percentile(0.99));
+    std::printf("%.0f requests/s in %.3f s, %zu failed\n", total / seconds, seconds, failed);
+    return failed ? 3 : 0;
+}